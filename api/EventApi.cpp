@@ -25,8 +25,11 @@
 #include <airdcpp/LogManager.h>
 
 namespace webserver {
+	SharedInstanceMap<LogManager*, EventApi::LogEventFanout> EventApi::logEventFanouts;
+
 	EventApi::EventApi(Session* aSession) : 
-		SubscribableApiModule(aSession, Access::EVENTS_VIEW, { "event_message", "event_counts" }) 
+		SubscribableApiModule(aSession, Access::EVENTS_VIEW, { "event_message", "event_counts" }),
+		logEventFanout(logEventFanouts.get(LogManager::getInstance()))
 	{
 		METHOD_HANDLER(Access::EVENTS_VIEW, METHOD_POST,	(EXACT_PARAM("read")),		EventApi::handleRead);
 		METHOD_HANDLER(Access::EVENTS_VIEW, METHOD_GET,		(EXACT_PARAM("counts")),	EventApi::handleGetInfo);
@@ -35,11 +38,11 @@ namespace webserver {
 		METHOD_HANDLER(Access::EVENTS_EDIT, METHOD_DELETE,	(),							EventApi::handleClearMessages);
 		METHOD_HANDLER(Access::EVENTS_EDIT, METHOD_POST,	(),							EventApi::handlePostMessage);
 
-		LogManager::getInstance()->addListener(this);
+		logEventFanout->addModule(this);
 	}
 
 	EventApi::~EventApi() {
-		LogManager::getInstance()->removeListener(this);
+		logEventFanout->removeModule(this);
 	}
 
 	api_return EventApi::handlePostMessage(ApiRequest& aRequest) {
@@ -73,27 +76,39 @@ namespace webserver {
 		return websocketpp::http::status_code::ok;
 	}
 
-	void EventApi::on(LogManagerListener::Message, const LogMessagePtr& aMessageData) noexcept {
-		if (subscriptionActive("event_message")) {
-			send("event_message", Serializer::serializeLogMessage(aMessageData));
-		}
+	EventApi::LogEventFanout::LogEventFanout() : messageFanout("event_message"), countsFanout("event_counts") {
+		LogManager::getInstance()->addListener(this);
+	}
 
-		onMessagesChanged();
+	EventApi::LogEventFanout::~LogEventFanout() {
+		LogManager::getInstance()->removeListener(this);
 	}
 
-	void EventApi::onMessagesChanged() noexcept {
-		if (!subscriptionActive("event_counts")) {
-			return;
-		}
+	void EventApi::LogEventFanout::addModule(EventApi* aModule) noexcept {
+		messageFanout.addModule(aModule);
+		countsFanout.addModule(aModule);
+	}
+
+	void EventApi::LogEventFanout::removeModule(EventApi* aModule) noexcept {
+		messageFanout.removeModule(aModule);
+		countsFanout.removeModule(aModule);
+	}
+
+	void EventApi::LogEventFanout::on(LogManagerListener::Message, const LogMessagePtr& aMessageData) noexcept {
+		messageFanout.maybeSend([&] { return Serializer::serializeLogMessage(aMessageData); });
+
+		onMessagesChanged();
+	}
 
-		send("event_counts", Serializer::serializeCacheInfo(LogManager::getInstance()->getCache(), Serializer::serializeUnreadLog));
+	void EventApi::LogEventFanout::onMessagesChanged() noexcept {
+		countsFanout.maybeSend([] { return Serializer::serializeCacheInfo(LogManager::getInstance()->getCache(), Serializer::serializeUnreadLog); });
 	}
 
-	void EventApi::on(LogManagerListener::Cleared) noexcept {
+	void EventApi::LogEventFanout::on(LogManagerListener::Cleared) noexcept {
 		onMessagesChanged();
 	}
 
-	void EventApi::on(LogManagerListener::MessagesRead) noexcept {
+	void EventApi::LogEventFanout::on(LogManagerListener::MessagesRead) noexcept {
 		onMessagesChanged();
 	}
 }
\ No newline at end of file
@@ -20,17 +20,43 @@
 #define DCPLUSPLUS_DCPP_LOGAPI_H
 
 #include <api/base/ApiModule.h>
+#include <api/base/EventFanout.h>
 
 #include <airdcpp/typedefs.h>
 #include <airdcpp/LogManagerListener.h>
 
+namespace dcpp {
+	class LogManager;
+}
+
 namespace webserver {
-	class EventApi : public SubscribableApiModule, private LogManagerListener {
+	class EventApi : public SubscribableApiModule {
 	public:
 		EventApi(Session* aSession);
 		~EventApi();
 	private:
-		void onMessagesChanged() noexcept;
+		// Log events are identical for all sessions so they are listened and serialized only once
+		class LogEventFanout : private LogManagerListener {
+		public:
+			LogEventFanout();
+			~LogEventFanout();
+
+			void addModule(EventApi* aModule) noexcept;
+			void removeModule(EventApi* aModule) noexcept;
+		private:
+			void onMessagesChanged() noexcept;
+
+			// LogManagerListener
+			void on(LogManagerListener::Message, const LogMessagePtr& aMessageData) noexcept override;
+			void on(LogManagerListener::Cleared) noexcept override;
+			void on(LogManagerListener::MessagesRead) noexcept override;
+
+			EventFanout messageFanout;
+			EventFanout countsFanout;
+		};
+
+		static SharedInstanceMap<LogManager*, LogEventFanout> logEventFanouts;
+		const shared_ptr<LogEventFanout> logEventFanout;
 
 		api_return handleGetInfo(ApiRequest& aRequest);
 		api_return handleRead(ApiRequest& aRequest);
@@ -38,11 +64,6 @@ namespace webserver {
 		api_return handleGetMessages(ApiRequest& aRequest);
 		api_return handleClearMessages(ApiRequest& aRequest);
 		api_return handlePostMessage(ApiRequest& aRequest);
-
-		// LogManagerListener
-		void on(LogManagerListener::Message, const LogMessagePtr& aMessageData) noexcept override;
-		void on(LogManagerListener::Cleared) noexcept override;
-		void on(LogManagerListener::MessagesRead) noexcept override;
 	};
 }
 
@@ -50,8 +50,9 @@ namespace webserver {
 	}
 
 	api_return FavoriteHubApi::handleGetHubs(ApiRequest& aRequest) {
-		auto j = Serializer::serializeItemList(aRequest.getRangeParam(START_POS), aRequest.getRangeParam(MAX_COUNT), FavoriteHubUtils::propertyHandler, getEntryList());
-		aRequest.setResponseBody(j);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, aRequest.getRangeParam(START_POS), aRequest.getRangeParam(MAX_COUNT), FavoriteHubUtils::propertyHandler, getEntryList());
+		aRequest.setSerializedResponseBody(std::move(writer));
 
 		return websocketpp::http::status_code::ok;
 	}
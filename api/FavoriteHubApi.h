@@ -47,7 +47,7 @@ namespace webserver {
 		void on(FavoriteManagerListener::FavoriteHubRemoved, const FavoriteHubEntryPtr& e) noexcept override;
 		void on(FavoriteManagerListener::FavoriteHubUpdated, const FavoriteHubEntryPtr& e) noexcept override;
 
-		typedef ListViewController<FavoriteHubEntryPtr, FavoriteHubUtils::PROP_LAST> HubView;
+		typedef ListViewController<FavoriteHubEntryPtr, FavoriteHubUtils::PROP_LAST, &FavoriteHubUtils::accessors> HubView;
 		HubView view;
 
 		static FavoriteHubEntryList getEntryList() noexcept;
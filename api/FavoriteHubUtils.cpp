@@ -130,28 +130,11 @@ namespace webserver {
 		return aSetting;
 	}
 
-	std::string FavoriteHubUtils::getStringInfo(const FavoriteHubEntryPtr& aEntry, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-			case PROP_NAME: return aEntry->getName();
-			case PROP_HUB_URL: return aEntry->getServer();
-			case PROP_HUB_DESCRIPTION: return aEntry->getDescription();
-			case PROP_NICK: return serializeHubSetting(aEntry->get(HubSettings::Nick));
-			case PROP_USER_DESCRIPTION: return serializeHubSetting(aEntry->get(HubSettings::Description));
-			case PROP_SHARE_PROFILE: return HubSettings::defined(aEntry->get(HubSettings::ShareProfile)) ? aEntry->getShareProfileName() : Util::emptyString;
-			case PROP_NMDC_ENCODING: return serializeHubSetting(aEntry->get(HubSettings::NmdcEncoding));
-			case PROP_IP4: return serializeHubSetting(aEntry->get(HubSettings::UserIp));
-			case PROP_IP6: return serializeHubSetting(aEntry->get(HubSettings::UserIp6));
-			default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& FavoriteHubUtils::getStringInfo(const FavoriteHubEntryPtr& aEntry, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aEntry, aPropertyName, buffer_);
 	}
 
 	double FavoriteHubUtils::getNumericInfo(const FavoriteHubEntryPtr& aEntry, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-			case PROP_AUTO_CONNECT: return (double)aEntry->getAutoConnect();
-			case PROP_HAS_PASSWORD: return (double)!aEntry->getPassword().empty();
-			case PROP_CONN_MODE4: return (double)aEntry->get(HubSettings::Connection);
-			case PROP_CONN_MODE6: return (double)aEntry->get(HubSettings::Connection6);
-			default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aEntry, aPropertyName);
 	}
 }
\ No newline at end of file
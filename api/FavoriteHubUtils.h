@@ -53,7 +53,7 @@ namespace webserver {
 		static json serializeHub(const FavoriteHubEntryPtr& aEntry, int aPropertyName) noexcept;
 
 		static int compareEntries(const FavoriteHubEntryPtr& a, const FavoriteHubEntryPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const FavoriteHubEntryPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const FavoriteHubEntryPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const FavoriteHubEntryPtr& a, int aPropertyName) noexcept;
 	private:
 		static string getConnectStateStr(const FavoriteHubEntryPtr& aEntry) noexcept;
@@ -62,7 +62,28 @@ namespace webserver {
 		static json serializeHubSetting(tribool aSetting) noexcept;
 		static json serializeHubSetting(int aSetting) noexcept;
 		static string serializeHubSetting(const string& aSetting) noexcept;
+
+	public:
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<FavoriteHubEntryPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(aEntry->getName(), buffer_); }, nullptr },
+			{ PROP_HUB_URL, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(aEntry->getServer(), buffer_); }, nullptr },
+			{ PROP_HUB_DESCRIPTION, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(aEntry->getDescription(), buffer_); }, nullptr },
+			{ PROP_AUTO_CONNECT, nullptr, [](const FavoriteHubEntryPtr& aEntry) -> double { return (double)aEntry->getAutoConnect(); } },
+			{ PROP_SHARE_PROFILE, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(HubSettings::defined(aEntry->get(HubSettings::ShareProfile)) ? aEntry->getShareProfileName() : Util::emptyString, buffer_); }, nullptr },
+			{ PROP_CONNECT_STATE, nullptr, nullptr },
+			{ PROP_NICK, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(serializeHubSetting(aEntry->get(HubSettings::Nick)), buffer_); }, nullptr },
+			{ PROP_HAS_PASSWORD, nullptr, [](const FavoriteHubEntryPtr& aEntry) -> double { return (double)!aEntry->getPassword().empty(); } },
+			{ PROP_USER_DESCRIPTION, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(serializeHubSetting(aEntry->get(HubSettings::Description)), buffer_); }, nullptr },
+			{ PROP_NMDC_ENCODING, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(serializeHubSetting(aEntry->get(HubSettings::NmdcEncoding)), buffer_); }, nullptr },
+			{ PROP_CONN_MODE4, nullptr, [](const FavoriteHubEntryPtr& aEntry) -> double { return (double)aEntry->get(HubSettings::Connection); } },
+			{ PROP_CONN_MODE6, nullptr, [](const FavoriteHubEntryPtr& aEntry) -> double { return (double)aEntry->get(HubSettings::Connection6); } },
+			{ PROP_IP4, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(serializeHubSetting(aEntry->get(HubSettings::UserIp)), buffer_); }, nullptr },
+			{ PROP_IP6, [](const FavoriteHubEntryPtr& aEntry, string& buffer_) -> const string& { return toPropertyString(serializeHubSetting(aEntry->get(HubSettings::UserIp6)), buffer_); }, nullptr },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(FavoriteHubUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
@@ -97,10 +97,15 @@ namespace webserver {
 				return websocketpp::http::status_code::service_unavailable;
 			}
 
-			aRequest.setResponseBody({
-				{ "list_path", curDir->getAdcPath() },
-				{ "items", Serializer::serializeItemList(start, count, FilelistUtils::propertyHandler, currentViewItems) },
-			});
+			JsonWriter writer;
+			writer.startObject();
+			writer.writeKey("items");
+			Serializer::serializeItemList(writer, start, count, FilelistUtils::propertyHandler, currentViewItems);
+			writer.writeKey("list_path");
+			writer.writeString(curDir->getAdcPath());
+			writer.endObject();
+
+			aRequest.setSerializedResponseBody(std::move(writer));
 		}
 
 		return websocketpp::http::status_code::ok;
@@ -79,7 +79,7 @@ namespace webserver {
 
 		DirectoryListingPtr dl;
 
-		typedef ListViewController<FilelistItemInfoPtr, FilelistUtils::PROP_LAST> DirectoryView;
+		typedef ListViewController<FilelistItemInfoPtr, FilelistUtils::PROP_LAST, &FilelistUtils::accessors> DirectoryView;
 		DirectoryView directoryView;
 
 		void onSessionUpdated(const json& aData) noexcept;
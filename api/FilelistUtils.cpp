@@ -90,29 +90,11 @@ namespace webserver {
 		}
 	}
 
-	std::string FilelistUtils::getStringInfo(const FilelistItemInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return aItem->getName();
-		case PROP_PATH: return aItem->getAdcPath();
-		case PROP_TYPE: {
-			if (aItem->isDirectory()) {
-				return Util::formatDirectoryContent(aItem->dir->getContentInfo());
-			}
-
-			return Util::formatFileType(aItem->getAdcPath());
-		}
-		case PROP_TTH: return aItem->getType() == FilelistItemInfo::FILE ? aItem->file->getTTH().toBase32() : Util::emptyString;
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& FilelistUtils::getStringInfo(const FilelistItemInfoPtr& aItem, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aItem, aPropertyName, buffer_);
 	}
 
 	double FilelistUtils::getNumericInfo(const FilelistItemInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)aItem->getSize();
-		case PROP_DATE: return (double)aItem->getDate();
-		case PROP_DUPE: return (double)aItem->getDupe();
-		case PROP_COMPLETE: return (double)aItem->isComplete();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aItem, aPropertyName);
 	}
 }
\ No newline at end of file
@@ -47,9 +47,29 @@ namespace webserver {
 		static json serializeItem(const FilelistItemInfoPtr& aResult, int aPropertyName) noexcept;
 
 		static int compareItems(const FilelistItemInfoPtr& a, const FilelistItemInfoPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const FilelistItemInfoPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const FilelistItemInfoPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const FilelistItemInfoPtr& a, int aPropertyName) noexcept;
+
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<FilelistItemInfoPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const FilelistItemInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getName(), buffer_); }, nullptr },
+			{ PROP_TYPE, [](const FilelistItemInfoPtr& aItem, string& buffer_) -> const string& {
+				if (aItem->isDirectory()) {
+					return toPropertyString(Util::formatDirectoryContent(aItem->dir->getContentInfo()), buffer_);
+				}
+
+				return toPropertyString(Util::formatFileType(aItem->getAdcPath()), buffer_);
+			}, nullptr },
+			{ PROP_SIZE, nullptr, [](const FilelistItemInfoPtr& aItem) -> double { return (double)aItem->getSize(); } },
+			{ PROP_DATE, nullptr, [](const FilelistItemInfoPtr& aItem) -> double { return (double)aItem->getDate(); } },
+			{ PROP_PATH, [](const FilelistItemInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getAdcPath(), buffer_); }, nullptr },
+			{ PROP_TTH, [](const FilelistItemInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getType() == FilelistItemInfo::FILE ? aItem->file->getTTH().toBase32() : Util::emptyString, buffer_); }, nullptr },
+			{ PROP_DUPE, nullptr, [](const FilelistItemInfoPtr& aItem) -> double { return (double)aItem->getDupe(); } },
+			{ PROP_COMPLETE, nullptr, [](const FilelistItemInfoPtr& aItem) -> double { return (double)aItem->isComplete(); } },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(FilelistUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
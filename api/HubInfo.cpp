@@ -41,11 +41,14 @@ namespace webserver {
 		"hub_user_disconnected",
 	};
 
+	SharedInstanceMap<ClientToken, HubInfo::UserEventFanout> HubInfo::userEventFanouts;
+
 	HubInfo::HubInfo(ParentType* aParentModule, const ClientPtr& aClient) :
 		SubApiModule(aParentModule, aClient->getToken(), subscriptionList), client(aClient),
 		chatHandler(this, std::bind(&HubInfo::getClient, this), "hub", Access::HUBS_VIEW, Access::HUBS_EDIT, Access::HUBS_SEND), 
 		view("hub_user_view", this, OnlineUserUtils::propertyHandler, std::bind(&HubInfo::getUsers, this), 500), 
-		timer(getTimer([this] { onTimer(); }, 1000)) 
+		timer(getTimer([this] { onTimer(); }, 1000)),
+		userEventFanout(userEventFanouts.get(aClient->getToken(), aClient))
 	{
 
 		METHOD_HANDLER(Access::HUBS_EDIT, METHOD_POST,	(EXACT_PARAM("reconnect")),	HubInfo::handleReconnect);
@@ -63,11 +66,13 @@ namespace webserver {
 	HubInfo::~HubInfo() {
 		timer->stop(true);
 
+		userEventFanout->removeModule(this);
 		client->removeListener(this);
 	}
 
 	void HubInfo::init() noexcept {
 		client->addListener(this);
+		userEventFanout->addModule(this);
 
 		timer->start(false);
 	}
@@ -83,8 +88,9 @@ namespace webserver {
 		auto start = aRequest.getRangeParam(START_POS);
 		auto count = aRequest.getRangeParam(MAX_COUNT);
 
-		auto j = Serializer::serializeItemList(start, count, OnlineUserUtils::propertyHandler, users);
-		aRequest.setResponseBody(j);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, start, count, OnlineUserUtils::propertyHandler, users);
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
@@ -297,8 +303,6 @@ namespace webserver {
 		if (!aUser->isHidden()) {
 			view.onItemAdded(aUser);
 		}
-
-		maybeSend("hub_user_connected", [&] { return Serializer::serializeItem(aUser, OnlineUserUtils::propertyHandler); });
 	}
 
 	void HubInfo::onUserUpdated(const OnlineUserPtr& ou) noexcept {
@@ -316,8 +320,6 @@ namespace webserver {
 		if (!aUser->isHidden()) {
 			view.onItemUpdated(aUser, aUpdatedProperties);
 		}
-
-		maybeSend("hub_user_updated", [&] { return Serializer::serializeItem(aUser, OnlineUserUtils::propertyHandler); });
 	}
 
 	void HubInfo::on(ClientListener::UserUpdated, const Client*, const OnlineUserPtr& aUser) noexcept {
@@ -334,7 +336,55 @@ namespace webserver {
 		if (!aUser->isHidden()) {
 			view.onItemRemoved(aUser);
 		}
+	}
+
+	HubInfo::UserEventFanout::UserEventFanout(const ClientPtr& aClient) : client(aClient),
+		userConnectedFanout("hub_user_connected"), userUpdatedFanout("hub_user_updated"), userDisconnectedFanout("hub_user_disconnected") {
+
+		client->addListener(this);
+	}
+
+	HubInfo::UserEventFanout::~UserEventFanout() {
+		client->removeListener(this);
+	}
+
+	void HubInfo::UserEventFanout::addModule(HubInfo* aModule) noexcept {
+		userConnectedFanout.addModule(aModule);
+		userUpdatedFanout.addModule(aModule);
+		userDisconnectedFanout.addModule(aModule);
+	}
+
+	void HubInfo::UserEventFanout::removeModule(HubInfo* aModule) noexcept {
+		userConnectedFanout.removeModule(aModule);
+		userUpdatedFanout.removeModule(aModule);
+		userDisconnectedFanout.removeModule(aModule);
+	}
+
+	void HubInfo::UserEventFanout::on(ClientListener::UserConnected, const Client*, const OnlineUserPtr& aUser) noexcept {
+		userConnectedFanout.maybeSend([&] { return Serializer::serializeItem(aUser, OnlineUserUtils::propertyHandler); });
+	}
+
+	void HubInfo::UserEventFanout::onUserUpdated(const OnlineUserPtr& aUser) noexcept {
+		userUpdatedFanout.maybeSendEvent([&] { return Serializer::serializeItem<EventJson>(aUser, OnlineUserUtils::propertyHandler); });
+	}
+
+	void HubInfo::UserEventFanout::on(ClientListener::UserUpdated, const Client*, const OnlineUserPtr& aUser) noexcept {
+		onUserUpdated(aUser);
+	}
+
+	void HubInfo::UserEventFanout::on(ClientListener::UsersUpdated, const Client*, const OnlineUserList& aUsers) noexcept {
+		for (auto& u : aUsers) {
+			onUserUpdated(u);
+		}
+	}
+
+	void HubInfo::UserEventFanout::on(ClientListener::UserRemoved, const Client*, const OnlineUserPtr& aUser) noexcept {
+		userDisconnectedFanout.maybeSend([&] { return Serializer::serializeItem(aUser, OnlineUserUtils::propertyHandler); });
+	}
 
-		maybeSend("hub_user_disconnected", [&] { return Serializer::serializeItem(aUser, OnlineUserUtils::propertyHandler); });
+	void HubInfo::UserEventFanout::on(ClientListener::Redirected, const string&, const ClientPtr& aNewClient) noexcept {
+		client->removeListener(this);
+		client = aNewClient;
+		aNewClient->addListener(this);
 	}
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include <airdcpp/Client.h>
 #include <airdcpp/Message.h>
 
+#include <api/base/EventFanout.h>
 #include <api/base/HierarchicalApiModule.h>
 #include <api/base/HookApiModule.h>
 #include <api/OnlineUserUtils.h>
@@ -55,6 +56,32 @@ namespace webserver {
 		void init() noexcept override;
 		ClientToken getId() const noexcept override;
 	private:
+		// User events are identical for all sessions so they are listened and serialized only once per hub
+		class UserEventFanout : private ClientListener {
+		public:
+			UserEventFanout(const ClientPtr& aClient);
+			~UserEventFanout();
+
+			void addModule(HubInfo* aModule) noexcept;
+			void removeModule(HubInfo* aModule) noexcept;
+		private:
+			void onUserUpdated(const OnlineUserPtr& aUser) noexcept;
+
+			void on(ClientListener::UserConnected, const Client*, const OnlineUserPtr&) noexcept override;
+			void on(ClientListener::UserUpdated, const Client*, const OnlineUserPtr&) noexcept override;
+			void on(ClientListener::UsersUpdated, const Client*, const OnlineUserList&) noexcept override;
+			void on(ClientListener::UserRemoved, const Client*, const OnlineUserPtr&) noexcept override;
+			void on(ClientListener::Redirected, const string&, const ClientPtr& aNewClient) noexcept override;
+
+			ClientPtr client;
+
+			EventFanout userConnectedFanout;
+			EventFanout userUpdatedFanout;
+			EventFanout userDisconnectedFanout;
+		};
+
+		static SharedInstanceMap<ClientToken, UserEventFanout> userEventFanouts;
+
 		api_return handleReconnect(ApiRequest& aRequest);
 		api_return handleFavorite(ApiRequest& aRequest);
 		api_return handlePassword(ApiRequest& aRequest);
@@ -110,10 +137,12 @@ namespace webserver {
 		ChatController<ClientPtr> chatHandler;
 		ClientPtr client;
 
-		typedef ListViewController<OnlineUserPtr, OnlineUserUtils::PROP_LAST> UserView;
+		typedef ListViewController<OnlineUserPtr, OnlineUserUtils::PROP_LAST, &OnlineUserUtils::accessors> UserView;
 		UserView view;
 
 		TimerPtr timer;
+
+		const shared_ptr<UserEventFanout> userEventFanout;
 	};
 
 	typedef HubInfo::Ptr HubInfoPtr;
@@ -86,29 +86,10 @@ namespace webserver {
 
 		return 0;
 	}
-	std::string OnlineUserUtils::getStringInfo(const OnlineUserPtr& aUser, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NICK: return aUser->getIdentity().getNick();
-		case PROP_DESCRIPTION: return aUser->getIdentity().getDescription();
-		case PROP_EMAIL: return aUser->getIdentity().getEmail();
-		case PROP_TAG: return aUser->getIdentity().getTag();
-		case PROP_HUB_URL: return aUser->getHubUrl();
-		case PROP_HUB_NAME: return aUser->getClient()->getHubName();
-		case PROP_IP4: return Format::formatIp(aUser->getIdentity().getIp4());
-		case PROP_IP6: return Format::formatIp(aUser->getIdentity().getIp6());
-		case PROP_CID: return aUser->getUser()->getCID().toBase32();
-		default: dcassert(0); return 0;
-		}
+	const std::string& OnlineUserUtils::getStringInfo(const OnlineUserPtr& aUser, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aUser, aPropertyName, buffer_);
 	}
 	double OnlineUserUtils::getNumericInfo(const OnlineUserPtr& aUser, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SHARED: return Util::toDouble(aUser->getIdentity().getShareSize());
-		case PROP_UPLOAD_SPEED: return (double)aUser->getIdentity().getAdcConnectionSpeed(false);
-		case PROP_DOWNLOAD_SPEED: return (double)aUser->getIdentity().getAdcConnectionSpeed(true);
-		case PROP_FILES: return Util::toDouble(aUser->getIdentity().getSharedFiles());
-		case PROP_HUB_ID: return aUser->getClient()->getToken();
-		case PROP_UPLOAD_SLOTS: return aUser->getIdentity().getSlots();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aUser, aPropertyName);
 	}
 }
\ No newline at end of file
@@ -22,8 +22,11 @@
 #include "stdinc.h"
 
 #include <api/common/Property.h>
+#include <api/common/Format.h>
 
 #include <airdcpp/typedefs.h>
+#include <airdcpp/Client.h>
+#include <airdcpp/OnlineUser.h>
 
 
 namespace webserver {
@@ -56,9 +59,31 @@ namespace webserver {
 		static json serializeUser(const OnlineUserPtr& aUser, int aPropertyName) noexcept;
 
 		static int compareUsers(const OnlineUserPtr& a, const OnlineUserPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const OnlineUserPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const OnlineUserPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const OnlineUserPtr& a, int aPropertyName) noexcept;
+
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<OnlineUserPtr, PROP_LAST> accessors = {{
+			{ PROP_NICK, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getIdentity().getNick(), buffer_); }, nullptr },
+			{ PROP_SHARED, nullptr, [](const OnlineUserPtr& aUser) -> double { return Util::toDouble(aUser->getIdentity().getShareSize()); } },
+			{ PROP_DESCRIPTION, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getIdentity().getDescription(), buffer_); }, nullptr },
+			{ PROP_TAG, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getIdentity().getTag(), buffer_); }, nullptr },
+			{ PROP_UPLOAD_SPEED, nullptr, [](const OnlineUserPtr& aUser) -> double { return (double)aUser->getIdentity().getAdcConnectionSpeed(false); } },
+			{ PROP_DOWNLOAD_SPEED, nullptr, [](const OnlineUserPtr& aUser) -> double { return (double)aUser->getIdentity().getAdcConnectionSpeed(true); } },
+			{ PROP_IP4, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(Format::formatIp(aUser->getIdentity().getIp4()), buffer_); }, nullptr },
+			{ PROP_IP6, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(Format::formatIp(aUser->getIdentity().getIp6()), buffer_); }, nullptr },
+			{ PROP_EMAIL, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getIdentity().getEmail(), buffer_); }, nullptr },
+			{ PROP_FILES, nullptr, [](const OnlineUserPtr& aUser) -> double { return Util::toDouble(aUser->getIdentity().getSharedFiles()); } },
+			{ PROP_HUB_ID, nullptr, [](const OnlineUserPtr& aUser) -> double { return aUser->getClient()->getToken(); } },
+			{ PROP_HUB_URL, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getHubUrl(), buffer_); }, nullptr },
+			{ PROP_HUB_NAME, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getClient()->getHubName(), buffer_); }, nullptr },
+			{ PROP_FLAGS, nullptr, nullptr },
+			{ PROP_CID, [](const OnlineUserPtr& aUser, string& buffer_) -> const string& { return toPropertyString(aUser->getUser()->getCID().toBase32(), buffer_); }, nullptr },
+			{ PROP_UPLOAD_SLOTS, nullptr, [](const OnlineUserPtr& aUser) -> double { return aUser->getIdentity().getSlots(); } },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(OnlineUserUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
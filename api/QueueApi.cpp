@@ -190,9 +190,10 @@ namespace webserver {
 		int start = aRequest.getRangeParam(START_POS);
 		int count = aRequest.getRangeParam(MAX_COUNT);
 
-		auto j = Serializer::serializeItemList(start, count, QueueBundleUtils::propertyHandler, getBundleList());
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, start, count, QueueBundleUtils::propertyHandler, getBundleList());
 
-		aRequest.setResponseBody(j);
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
@@ -256,9 +257,10 @@ namespace webserver {
 
 		int start = aRequest.getRangeParam(START_POS);
 		int count = aRequest.getRangeParam(MAX_COUNT);
-		auto j = Serializer::serializeItemList(start, count, QueueFileUtils::propertyHandler, files);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, start, count, QueueFileUtils::propertyHandler, files);
 
-		aRequest.setResponseBody(j);
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
@@ -545,7 +547,7 @@ namespace webserver {
 		send("queue_file_removed", Serializer::serializeItem(aQI, QueueFileUtils::propertyHandler));
 	}
 
-	void QueueApi::onFileUpdated(const QueueItemPtr& aQI, const PropertyIdSet& aUpdatedProperties, const string& aSubscription) {
+	void QueueApi::onFileUpdated(const QueueItemPtr& aQI, const PropertyIdSet& aUpdatedProperties, SubscriptionId aSubscription) {
 		fileView.onItemUpdated(aQI, aUpdatedProperties);
 		if (subscriptionActive(aSubscription)) {
 			// Serialize full item for more specific updates to make reading of data easier 
@@ -553,34 +555,34 @@ namespace webserver {
 			send(aSubscription, Serializer::serializeItem(aQI, QueueFileUtils::propertyHandler));
 		}
 
-		if (subscriptionActive("queue_file_updated")) {
+		if (subscriptionActive(fileUpdatedSubscription)) {
 			// Serialize updated properties only
-			send("queue_file_updated", Serializer::serializePartialItem(aQI, QueueFileUtils::propertyHandler, aUpdatedProperties));
+			send(fileUpdatedSubscription, Serializer::serializePartialItem(aQI, QueueFileUtils::propertyHandler, aUpdatedProperties));
 		}
 	}
 
 	void QueueApi::on(QueueManagerListener::ItemSources, const QueueItemPtr& aQI) noexcept {
-		onFileUpdated(aQI, { QueueFileUtils::PROP_SOURCES }, "queue_file_sources");
+		onFileUpdated(aQI, { QueueFileUtils::PROP_SOURCES }, getSubscriptionId("queue_file_sources"));
 	}
 
 	void QueueApi::on(QueueManagerListener::ItemStatus, const QueueItemPtr& aQI) noexcept {
 		onFileUpdated(aQI, { 
 			QueueFileUtils::PROP_STATUS, QueueFileUtils::PROP_TIME_FINISHED, QueueFileUtils::PROP_BYTES_DOWNLOADED, 
 			QueueFileUtils::PROP_SECONDS_LEFT, QueueFileUtils::PROP_SPEED 
-		}, "queue_file_status");
+		}, getSubscriptionId("queue_file_status"));
 	}
 
 	void QueueApi::on(QueueManagerListener::ItemPriority, const QueueItemPtr& aQI) noexcept {
 		onFileUpdated(aQI, {
 			QueueFileUtils::PROP_STATUS, QueueFileUtils::PROP_PRIORITY
-		}, "queue_file_priority");
+		}, getSubscriptionId("queue_file_priority"));
 	}
 
 	void QueueApi::on(QueueManagerListener::ItemTick, const QueueItemPtr& aQI) noexcept {
 		onFileUpdated(aQI, {
 			QueueFileUtils::PROP_STATUS, QueueFileUtils::PROP_BYTES_DOWNLOADED,
 			QueueFileUtils::PROP_SECONDS_LEFT, QueueFileUtils::PROP_SPEED
-		}, "queue_file_tick");
+		}, fileTickSubscription);
 	}
 
 	void QueueApi::on(QueueManagerListener::FileRecheckFailed, const QueueItemPtr&, const string&) noexcept {
@@ -604,45 +606,45 @@ namespace webserver {
 		send("queue_bundle_removed", Serializer::serializeItem(aBundle, QueueBundleUtils::propertyHandler));
 	}
 
-	void QueueApi::onBundleUpdated(const BundlePtr& aBundle, const PropertyIdSet& aUpdatedProperties, const string& aSubscription) {
+	void QueueApi::onBundleUpdated(const BundlePtr& aBundle, const PropertyIdSet& aUpdatedProperties, SubscriptionId aSubscription) {
 		bundleView.onItemUpdated(aBundle, aUpdatedProperties);
 		if (subscriptionActive(aSubscription)) {
 			// Serialize full item for more specific updates to make reading of data easier 
 			// (such as cases when the script is interested only in finished bundles)
-			send(aSubscription, Serializer::serializeItem(aBundle, QueueBundleUtils::propertyHandler));
+			sendEvent(aSubscription, Serializer::serializeItem<EventJson>(aBundle, QueueBundleUtils::propertyHandler));
 		}
 
-		if (subscriptionActive("queue_bundle_updated")) {
+		if (subscriptionActive(bundleUpdatedSubscription)) {
 			// Serialize updated properties only
-			send("queue_bundle_updated", Serializer::serializePartialItem(aBundle, QueueBundleUtils::propertyHandler, aUpdatedProperties));
+			sendEvent(bundleUpdatedSubscription, Serializer::serializePartialItem<EventJson>(aBundle, QueueBundleUtils::propertyHandler, aUpdatedProperties));
 		}
 	}
 
 	void QueueApi::on(QueueManagerListener::BundleSize, const BundlePtr& aBundle) noexcept {
-		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_SIZE, QueueBundleUtils::PROP_TYPE }, "queue_bundle_content");
+		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_SIZE, QueueBundleUtils::PROP_TYPE }, getSubscriptionId("queue_bundle_content"));
 	}
 
 	void QueueApi::on(QueueManagerListener::BundlePriority, const BundlePtr& aBundle) noexcept {
-		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_PRIORITY, QueueBundleUtils::PROP_STATUS }, "queue_bundle_priority");
+		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_PRIORITY, QueueBundleUtils::PROP_STATUS }, getSubscriptionId("queue_bundle_priority"));
 	}
 
 	void QueueApi::on(QueueManagerListener::BundleStatusChanged, const BundlePtr& aBundle) noexcept {
-		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_STATUS, QueueBundleUtils::PROP_TIME_FINISHED }, "queue_bundle_status");
+		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_STATUS, QueueBundleUtils::PROP_TIME_FINISHED }, getSubscriptionId("queue_bundle_status"));
 	}
 
 	void QueueApi::on(QueueManagerListener::BundleSources, const BundlePtr& aBundle) noexcept {
-		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_SOURCES }, "queue_bundle_sources");
+		onBundleUpdated(aBundle, { QueueBundleUtils::PROP_SOURCES }, getSubscriptionId("queue_bundle_sources"));
 	}
 
 #define TICK_PROPS { QueueBundleUtils::PROP_SECONDS_LEFT, QueueBundleUtils::PROP_SPEED, QueueBundleUtils::PROP_STATUS, QueueBundleUtils::PROP_BYTES_DOWNLOADED }
 	void QueueApi::on(DownloadManagerListener::BundleTick, const BundleList& aTickBundles, uint64_t /*aTick*/) noexcept {
 		for (const auto& b : aTickBundles) {
-			onBundleUpdated(b, TICK_PROPS, "queue_bundle_tick");
+			onBundleUpdated(b, TICK_PROPS, bundleTickSubscription);
 		}
 	}
 
 	void QueueApi::on(DownloadManagerListener::BundleWaiting, const BundlePtr& aBundle) noexcept {
 		// "Waiting" isn't really a status (it's just meant to clear the props for running bundles...)
-		onBundleUpdated(aBundle, TICK_PROPS, "queue_bundle_tick");
+		onBundleUpdated(aBundle, TICK_PROPS, bundleTickSubscription);
 	}
 }
\ No newline at end of file
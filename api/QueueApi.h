@@ -110,13 +110,19 @@ namespace webserver {
 		void on(QueueManagerListener::ItemPriority, const QueueItemPtr& aQI) noexcept override;
 		void on(QueueManagerListener::ItemTick, const QueueItemPtr& aQI) noexcept override;
 
-		void onFileUpdated(const QueueItemPtr& aQI, const PropertyIdSet& aUpdatedProperties, const string& aSubscription);
-		void onBundleUpdated(const BundlePtr& aBundle, const PropertyIdSet& aUpdatedProperties, const string& aSubscription);
+		void onFileUpdated(const QueueItemPtr& aQI, const PropertyIdSet& aUpdatedProperties, SubscriptionId aSubscription);
+		void onBundleUpdated(const BundlePtr& aBundle, const PropertyIdSet& aUpdatedProperties, SubscriptionId aSubscription);
 
-		typedef ListViewController<BundlePtr, QueueBundleUtils::PROP_LAST> BundleListView;
+		// Subscriptions checked for each tick
+		const SubscriptionId fileTickSubscription = getSubscriptionId("queue_file_tick");
+		const SubscriptionId fileUpdatedSubscription = getSubscriptionId("queue_file_updated");
+		const SubscriptionId bundleTickSubscription = getSubscriptionId("queue_bundle_tick");
+		const SubscriptionId bundleUpdatedSubscription = getSubscriptionId("queue_bundle_updated");
+
+		typedef ListViewController<BundlePtr, QueueBundleUtils::PROP_LAST, &QueueBundleUtils::accessors> BundleListView;
 		BundleListView bundleView;
 
-		typedef ListViewController<QueueItemPtr, QueueFileUtils::PROP_LAST> FileListView;
+		typedef ListViewController<QueueItemPtr, QueueFileUtils::PROP_LAST, &QueueFileUtils::accessors> FileListView;
 		FileListView fileView;
 
 		static BundleList getBundleList() noexcept;
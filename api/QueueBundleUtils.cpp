@@ -53,16 +53,8 @@ namespace webserver {
 		return QueueManager::getInstance()->getSourceCount(aBundle).format();
 	}
 
-	std::string QueueBundleUtils::getStringInfo(const BundlePtr& b, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return b->getName();
-		case PROP_TARGET: return b->getTarget();
-		case PROP_TYPE: return formatBundleType(b);
-		case PROP_STATUS: return b->getStatusString();
-		case PROP_PRIORITY: return AirUtil::getPrioText(b->getPriority());
-		case PROP_SOURCES: return formatBundleSources(b);
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& QueueBundleUtils::getStringInfo(const BundlePtr& b, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, b, aPropertyName, buffer_);
 	}
 
 	std::string QueueBundleUtils::formatBundleType(const BundlePtr& aBundle) noexcept {
@@ -75,16 +67,7 @@ namespace webserver {
 
 	double QueueBundleUtils::getNumericInfo(const BundlePtr& b, int aPropertyName) noexcept {
 		dcassert(b->getSize() != 0);
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)b->getSize();
-		case PROP_BYTES_DOWNLOADED: return (double)b->getDownloadedBytes();
-		case PROP_PRIORITY: return (double)b->getPriority();
-		case PROP_TIME_ADDED: return (double)b->getTimeAdded();
-		case PROP_TIME_FINISHED: return (double)b->getTimeFinished();
-		case PROP_SPEED: return (double)b->getSpeed();
-		case PROP_SECONDS_LEFT: return (double)b->getSecondsLeft();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, b, aPropertyName);
 	}
 
 #define COMPARE_IS_DOWNLOADED(a, b) if (a->isDownloaded() != b->isDownloaded()) return a->isDownloaded() ? 1 : -1;
@@ -22,6 +22,8 @@
 #include <api/common/Property.h>
 
 #include <airdcpp/typedefs.h>
+#include <airdcpp/AirUtil.h>
+#include <airdcpp/Bundle.h>
 
 
 namespace webserver {
@@ -51,14 +53,33 @@ namespace webserver {
 
 		static int compareBundles(const BundlePtr& a, const BundlePtr& b, int aPropertyName) noexcept;
 
-		static std::string getStringInfo(const BundlePtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const BundlePtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const BundlePtr& a, int aPropertyName) noexcept;
 
 	private:
 		static std::string formatStatusId(const BundlePtr& aBundle) noexcept;
 		static std::string formatBundleSources(const BundlePtr& aBundle) noexcept;
 		static std::string formatBundleType(const BundlePtr& aBundle) noexcept;
+
+	public:
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<BundlePtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(b->getName(), buffer_); }, nullptr },
+			{ PROP_TARGET, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(b->getTarget(), buffer_); }, nullptr },
+			{ PROP_TYPE, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(formatBundleType(b), buffer_); }, nullptr },
+			{ PROP_SIZE, nullptr, [](const BundlePtr& b) -> double { return (double)b->getSize(); } },
+			{ PROP_STATUS, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(b->getStatusString(), buffer_); }, nullptr },
+			{ PROP_BYTES_DOWNLOADED, nullptr, [](const BundlePtr& b) -> double { return (double)b->getDownloadedBytes(); } },
+			{ PROP_PRIORITY, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(AirUtil::getPrioText(b->getPriority()), buffer_); }, [](const BundlePtr& b) -> double { return (double)b->getPriority(); } },
+			{ PROP_TIME_ADDED, nullptr, [](const BundlePtr& b) -> double { return (double)b->getTimeAdded(); } },
+			{ PROP_TIME_FINISHED, nullptr, [](const BundlePtr& b) -> double { return (double)b->getTimeFinished(); } },
+			{ PROP_SPEED, nullptr, [](const BundlePtr& b) -> double { return (double)b->getSpeed(); } },
+			{ PROP_SECONDS_LEFT, nullptr, [](const BundlePtr& b) -> double { return (double)b->getSecondsLeft(); } },
+			{ PROP_SOURCES, [](const BundlePtr& b, string& buffer_) -> const string& { return toPropertyString(formatBundleSources(b), buffer_); }, nullptr },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(QueueBundleUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
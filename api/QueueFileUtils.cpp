@@ -59,31 +59,12 @@ namespace webserver {
 		return QueueManager::getInstance()->getSourceCount(aItem).format();
 	}
 
-	std::string QueueFileUtils::getStringInfo(const QueueItemPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return getDisplayName(aItem);
-		case PROP_TARGET: return aItem->getTarget();
-		case PROP_TYPE: return Util::formatFileType(aItem->getTarget());
-		case PROP_STATUS: return formatDisplayStatus(aItem);
-		case PROP_PRIORITY: return AirUtil::getPrioText(aItem->getPriority());
-		case PROP_SOURCES: return formatFileSources(aItem);
-		case PROP_TTH: return aItem->getTTH().toBase32();
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& QueueFileUtils::getStringInfo(const QueueItemPtr& aItem, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aItem, aPropertyName, buffer_);
 	}
 
 	double QueueFileUtils::getNumericInfo(const QueueItemPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)aItem->getSize();
-		case PROP_BYTES_DOWNLOADED: return (double)QueueManager::getInstance()->getDownloadedBytes(aItem);
-		case PROP_PRIORITY: return (double)aItem->getPriority();
-		case PROP_TIME_ADDED: return (double)aItem->getTimeAdded();
-		case PROP_TIME_FINISHED: return (double)aItem->getTimeFinished();
-		case PROP_SPEED: return (double)QueueManager::getInstance()->getAverageSpeed(aItem);
-		case PROP_SECONDS_LEFT: return (double)QueueManager::getInstance()->getSecondsLeft(aItem);
-		case PROP_BUNDLE: return (double)(aItem->getBundle() ? aItem->getBundle()->getToken() : -1);
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aItem, aPropertyName);
 	}
 
 #define COMPARE_IS_DOWNLOADED(a, b) if (a->isDownloaded() != b->isDownloaded()) return a->isDownloaded() ? 1 : -1;
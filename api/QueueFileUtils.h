@@ -22,6 +22,10 @@
 #include <api/common/Property.h>
 
 #include <airdcpp/typedefs.h>
+#include <airdcpp/AirUtil.h>
+#include <airdcpp/Bundle.h>
+#include <airdcpp/QueueItem.h>
+#include <airdcpp/QueueManager.h>
 
 
 namespace webserver {
@@ -54,7 +58,7 @@ namespace webserver {
 
 		static int compareFiles(const QueueItemPtr& a, const QueueItemPtr& b, int aPropertyName) noexcept;
 
-		static std::string getStringInfo(const QueueItemPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const QueueItemPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const QueueItemPtr& a, int aPropertyName) noexcept;
 
 	private:
@@ -63,7 +67,28 @@ namespace webserver {
 
 		static std::string formatDisplayStatus(const QueueItemPtr& aItem) noexcept;
 		static std::string formatFileSources(const QueueItemPtr& aItem) noexcept;
+
+	public:
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<QueueItemPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(getDisplayName(aItem), buffer_); }, nullptr },
+			{ PROP_TARGET, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getTarget(), buffer_); }, nullptr },
+			{ PROP_TYPE, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(Util::formatFileType(aItem->getTarget()), buffer_); }, nullptr },
+			{ PROP_SIZE, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)aItem->getSize(); } },
+			{ PROP_STATUS, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(formatDisplayStatus(aItem), buffer_); }, nullptr },
+			{ PROP_BYTES_DOWNLOADED, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)QueueManager::getInstance()->getDownloadedBytes(aItem); } },
+			{ PROP_PRIORITY, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(AirUtil::getPrioText(aItem->getPriority()), buffer_); }, [](const QueueItemPtr& aItem) -> double { return (double)aItem->getPriority(); } },
+			{ PROP_TIME_ADDED, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)aItem->getTimeAdded(); } },
+			{ PROP_TIME_FINISHED, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)aItem->getTimeFinished(); } },
+			{ PROP_SPEED, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)QueueManager::getInstance()->getAverageSpeed(aItem); } },
+			{ PROP_SECONDS_LEFT, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)QueueManager::getInstance()->getSecondsLeft(aItem); } },
+			{ PROP_SOURCES, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(formatFileSources(aItem), buffer_); }, nullptr },
+			{ PROP_BUNDLE, nullptr, [](const QueueItemPtr& aItem) -> double { return (double)(aItem->getBundle() ? aItem->getBundle()->getToken() : -1); } },
+			{ PROP_TTH, [](const QueueItemPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getTTH().toBase32(), buffer_); }, nullptr },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(QueueFileUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
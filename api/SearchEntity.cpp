@@ -69,9 +69,10 @@ namespace webserver {
 
 	api_return SearchEntity::handleGetResults(ApiRequest& aRequest) {
 		// Serialize the most relevant results first
-		auto j = Serializer::serializeItemList(aRequest.getRangeParam(START_POS), aRequest.getRangeParam(MAX_COUNT), SearchUtils::propertyHandler, search->getResultSet());
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, aRequest.getRangeParam(START_POS), aRequest.getRangeParam(MAX_COUNT), SearchUtils::propertyHandler, search->getResultSet());
 
-		aRequest.setResponseBody(j);
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
@@ -206,8 +207,8 @@ namespace webserver {
 	void SearchEntity::on(SearchInstanceListener::GroupedResultAdded, const GroupedSearchResultPtr& aResult) noexcept {
 		searchView.onItemAdded(aResult);
 
-		if (subscriptionActive("search_result_added")) {
-			send("search_result_added", {
+		if (subscriptionActive(resultAddedSubscription)) {
+			send(resultAddedSubscription, {
 				{ "search_id", search->getCurrentSearchToken() },
 				{ "result", Serializer::serializeItem(aResult, SearchUtils::propertyHandler) }
 			});
@@ -221,8 +222,8 @@ namespace webserver {
 			SearchUtils::PROP_USERS
 		});
 		
-		if (subscriptionActive("search_result_updated")) {
-			send("search_result_updated", {
+		if (subscriptionActive(resultUpdatedSubscription)) {
+			send(resultUpdatedSubscription, {
 				{ "search_id", search->getCurrentSearchToken() },
 				{ "result", Serializer::serializeItem(aResult, SearchUtils::propertyHandler) }
 			});
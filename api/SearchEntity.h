@@ -71,8 +71,11 @@ namespace webserver {
 		void on(SearchInstanceListener::HubSearchSent, const string& aSearchToken, int aSent) noexcept override;
 		void on(SearchInstanceListener::HubSearchQueued, const string& aSearchToken, uint64_t aQueueTime, size_t aQueuedCount) noexcept override;
 
-		typedef ListViewController<GroupedSearchResultPtr, SearchUtils::PROP_LAST> SearchView;
+		typedef ListViewController<GroupedSearchResultPtr, SearchUtils::PROP_LAST, &SearchUtils::accessors> SearchView;
 		SearchView searchView;
+
+		const SubscriptionId resultAddedSubscription = getSubscriptionId("search_result_added");
+		const SubscriptionId resultUpdatedSubscription = getSubscriptionId("search_result_updated");
 	};
 }
 
@@ -117,35 +117,10 @@ namespace webserver {
 		default: dcassert(0); return 0;
 		}
 	}
-	std::string SearchUtils::getStringInfo(const GroupedSearchResultPtr& aResult, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return aResult->getFileName();
-		case PROP_PATH: return aResult->getAdcPath();
-		case PROP_USERS: return Format::formatNicks(aResult->getBaseUser());
-		case PROP_TYPE: {
-			if (aResult->isDirectory()) {
-				return Util::formatDirectoryContent(aResult->getContentInfo());
-			}
-
-			return Util::formatFileType(aResult->getAdcPath());
-		}
-		case PROP_SLOTS: {
-			auto slots = aResult->getSlots();
-			return SearchResult::formatSlots(slots.free, slots.total);
-		}
-		case PROP_TTH: return aResult->isDirectory() ? Util::emptyString : aResult->getTTH().toBase32();
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& SearchUtils::getStringInfo(const GroupedSearchResultPtr& aResult, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aResult, aPropertyName, buffer_);
 	}
 	double SearchUtils::getNumericInfo(const GroupedSearchResultPtr& aResult, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)aResult->getSize();
-		case PROP_HITS: return (double)aResult->getHits();
-		case PROP_CONNECTION: return aResult->getConnectionSpeed();
-		case PROP_RELEVANCE : return aResult->getTotalRelevance();
-		case PROP_DATE: return (double)aResult->getOldestDate();
-		case PROP_DUPE: return (double)aResult->getDupe();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aResult, aPropertyName);
 	}
 }
\ No newline at end of file
@@ -20,9 +20,11 @@
 #define DCPLUSPLUS_DCPP_SEARCHUTILS_H
 
 #include <api/common/Property.h>
+#include <api/common/Format.h>
 
 #include <airdcpp/typedefs.h>
 #include <airdcpp/GroupedSearchResult.h>
+#include <airdcpp/SearchResult.h>
 
 
 namespace webserver {
@@ -51,9 +53,36 @@ namespace webserver {
 		static json serializeResult(const GroupedSearchResultPtr& aResult, int aPropertyName) noexcept;
 
 		static int compareResults(const GroupedSearchResultPtr& a, const GroupedSearchResultPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const GroupedSearchResultPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const GroupedSearchResultPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const GroupedSearchResultPtr& a, int aPropertyName) noexcept;
+
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<GroupedSearchResultPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& { return toPropertyString(aResult->getFileName(), buffer_); }, nullptr },
+			{ PROP_RELEVANCE, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return aResult->getTotalRelevance(); } },
+			{ PROP_HITS, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return (double)aResult->getHits(); } },
+			{ PROP_USERS, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& { return toPropertyString(Format::formatNicks(aResult->getBaseUser()), buffer_); }, nullptr },
+			{ PROP_TYPE, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& {
+				if (aResult->isDirectory()) {
+					return toPropertyString(Util::formatDirectoryContent(aResult->getContentInfo()), buffer_);
+				}
+
+				return toPropertyString(Util::formatFileType(aResult->getAdcPath()), buffer_);
+			}, nullptr },
+			{ PROP_SIZE, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return (double)aResult->getSize(); } },
+			{ PROP_DATE, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return (double)aResult->getOldestDate(); } },
+			{ PROP_PATH, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& { return toPropertyString(aResult->getAdcPath(), buffer_); }, nullptr },
+			{ PROP_CONNECTION, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return aResult->getConnectionSpeed(); } },
+			{ PROP_SLOTS, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& {
+				auto slots = aResult->getSlots();
+				return toPropertyString(SearchResult::formatSlots(slots.free, slots.total), buffer_);
+			}, nullptr },
+			{ PROP_TTH, [](const GroupedSearchResultPtr& aResult, string& buffer_) -> const string& { return toPropertyString(aResult->isDirectory() ? Util::emptyString : aResult->getTTH().toBase32(), buffer_); }, nullptr },
+			{ PROP_DUPE, nullptr, [](const GroupedSearchResultPtr& aResult) -> double { return (double)aResult->getDupe(); } },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(SearchUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
@@ -163,6 +163,12 @@ namespace webserver {
 		}
 
 		auto sessionToken = JsonUtil::getField<string>("auth_token", aRequest.getRequestBody(), false);
+		auto encodingName = JsonUtil::getOptionalField<string>("encoding", aRequest.getRequestBody());
+
+		auto encoding = aSocket->getEncoding();
+		if (encodingName && !MessageEncoding::parse(*encodingName, encoding)) {
+			JsonUtil::throwError("encoding", JsonUtil::ERROR_INVALID, "Unsupported encoding (supported encodings: json, cbor, msgpack)");
+		}
 
 		auto session = WebServerManager::getInstance()->getUserManager().getSession(sessionToken);
 		if (!session) {
@@ -178,6 +184,9 @@ namespace webserver {
 		session->onSocketConnected(aSocket);
 		aSocket->setSession(session);
 
+		// The response is sent with the new encoding already
+		aSocket->setEncoding(encoding);
+
 		aRequest.setResponseBody(serializeLoginInfo(session, Util::emptyString));
 		return websocketpp::http::status_code::no_content;
 	}
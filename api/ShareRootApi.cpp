@@ -65,8 +65,9 @@ namespace webserver {
 	}
 
 	api_return ShareRootApi::handleGetRoots(ApiRequest& aRequest) {
-		auto j = Serializer::serializeItemList(ShareUtils::propertyHandler, ShareManager::getInstance()->getRootInfos());
-		aRequest.setResponseBody(j);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, ShareUtils::propertyHandler, ShareManager::getInstance()->getRootInfos());
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
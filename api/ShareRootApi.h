@@ -50,7 +50,7 @@ namespace webserver {
 
 		void on(HashManagerListener::FileHashed, const string& aFilePath, HashedFile& aFileInfo) noexcept override;
 
-		typedef ListViewController<ShareDirectoryInfoPtr, ShareUtils::PROP_LAST> RootView;
+		typedef ListViewController<ShareDirectoryInfoPtr, ShareUtils::PROP_LAST, &ShareUtils::accessors> RootView;
 		RootView rootView;
 
 		void onRootUpdated(const string& aPath, PropertyIdSet&& aUpdatedProperties) noexcept;
@@ -117,22 +117,10 @@ namespace webserver {
 		return 0;
 	}
 
-	std::string ShareUtils::getStringInfo(const ShareDirectoryInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_VIRTUAL_NAME: return aItem->virtualName;
-		case PROP_PATH: return aItem->path;
-		case PROP_STATUS: return formatDisplayStatus(aItem);
-		case PROP_TYPE: return Util::formatDirectoryContent(aItem->contentInfo);
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& ShareUtils::getStringInfo(const ShareDirectoryInfoPtr& aItem, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aItem, aPropertyName, buffer_);
 	}
 	double ShareUtils::getNumericInfo(const ShareDirectoryInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)aItem->size;
-		case PROP_INCOMING: return (double)aItem->incoming;
-		case PROP_LAST_REFRESH_TIME: return (double)aItem->lastRefreshTime;
-		case PROP_STATUS: return (double)aItem->refreshState;
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aItem, aPropertyName);
 	}
 }
\ No newline at end of file
@@ -52,9 +52,23 @@ namespace webserver {
 		static bool filterItem(const ShareDirectoryInfoPtr& aItem, int aPropertyName, const StringMatch& aTextMatcher, double aNumericMatcher) noexcept;
 
 		static int compareItems(const ShareDirectoryInfoPtr& a, const ShareDirectoryInfoPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const ShareDirectoryInfoPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const ShareDirectoryInfoPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const ShareDirectoryInfoPtr& a, int aPropertyName) noexcept;
+
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<ShareDirectoryInfoPtr, PROP_LAST> accessors = {{
+			{ PROP_PATH, [](const ShareDirectoryInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->path, buffer_); }, nullptr },
+			{ PROP_VIRTUAL_NAME, [](const ShareDirectoryInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->virtualName, buffer_); }, nullptr },
+			{ PROP_SIZE, nullptr, [](const ShareDirectoryInfoPtr& aItem) -> double { return (double)aItem->size; } },
+			{ PROP_PROFILES, nullptr, nullptr },
+			{ PROP_INCOMING, nullptr, [](const ShareDirectoryInfoPtr& aItem) -> double { return (double)aItem->incoming; } },
+			{ PROP_LAST_REFRESH_TIME, nullptr, [](const ShareDirectoryInfoPtr& aItem) -> double { return (double)aItem->lastRefreshTime; } },
+			{ PROP_STATUS, [](const ShareDirectoryInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(formatDisplayStatus(aItem), buffer_); }, [](const ShareDirectoryInfoPtr& aItem) -> double { return (double)aItem->refreshState; } },
+			{ PROP_TYPE, [](const ShareDirectoryInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(Util::formatDirectoryContent(aItem->contentInfo), buffer_); }, nullptr },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(ShareUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
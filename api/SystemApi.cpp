@@ -19,11 +19,13 @@
 #include "stdinc.h"
 #include <web-server/version.h>
 
+#include <web-server/JsonArena.h>
 #include <web-server/JsonUtil.h>
 #include <web-server/SystemUtil.h>
 #include <web-server/Timer.h>
 #include <web-server/WebServerManager.h>
 #include <web-server/WebServerSettings.h>
+#include <web-server/WebSocket.h>
 #include <web-server/WebUserManager.h>
 
 #include <api/SystemApi.h>
@@ -129,10 +131,39 @@ namespace webserver {
 
 	api_return SystemApi::handleGetStats(ApiRequest& aRequest) {
 		auto server = session->getServer();
+		auto eventJsonStats = JsonArena::getStats();
+		auto socketStats = server->getSocketStats();
+		auto deliveryStats = WebSocket::getDeliveryStats();
+		auto requestStats = server->getRequestPool().getStats();
 
 		aRequest.setResponseBody({
 			{ "server_threads", WEBCFG(SERVER_THREADS).num() },
 			{ "active_sessions", server->getUserManager().getUserSessionCount() },
+			{ "event_json", {
+				{ "events", eventJsonStats.events },
+				{ "allocations", eventJsonStats.allocations },
+				{ "allocations_per_event", eventJsonStats.events == 0 ? 0.0 : static_cast<double>(eventJsonStats.allocations) / eventJsonStats.events },
+				{ "max_event_allocations", eventJsonStats.maxEventAllocations },
+				{ "heap_allocations", eventJsonStats.heapAllocations },
+			} },
+			{ "sockets", {
+				{ "connected", socketStats.sockets },
+				{ "congested", socketStats.congestedSockets },
+				{ "buffered_bytes", socketStats.bufferedBytes },
+				{ "max_buffered_bytes", socketStats.maxBufferedBytes },
+				{ "congestions", deliveryStats.congestions },
+				{ "superseded_events", deliveryStats.supersededEvents },
+				{ "overflow_closes", deliveryStats.overflowCloses },
+			} },
+			{ "requests", {
+				{ "threads", requestStats.threads },
+				{ "pending", requestStats.pending },
+				{ "executed", requestStats.executed },
+				{ "inline", requestStats.inlined },
+				{ "rejected", requestStats.rejected },
+				{ "average_queue_time_us", requestStats.executed == 0 ? 0 : requestStats.totalQueueTime / requestStats.executed },
+				{ "max_queue_time_us", requestStats.maxQueueTime },
+			} },
 		});
 		return websocketpp::http::status_code::ok;
 	}
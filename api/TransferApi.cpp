@@ -81,8 +81,9 @@ namespace webserver {
 	}
 
 	api_return TransferApi::handleGetTransfers(ApiRequest& aRequest) {
-		auto j = Serializer::serializeItemList(TransferUtils::propertyHandler, getTransfers());
-		aRequest.setResponseBody(j);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, TransferUtils::propertyHandler, getTransfers());
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
@@ -194,8 +195,8 @@ namespace webserver {
 
 	void TransferApi::on(TransferInfoManagerListener::Added, const TransferInfoPtr& aInfo) noexcept {
 		view.onItemAdded(aInfo);
-		if (subscriptionActive("transfer_added")) {
-			send("transfer_added", Serializer::serializeItem(aInfo, TransferUtils::propertyHandler));
+		if (subscriptionActive(addedSubscription)) {
+			send(addedSubscription, Serializer::serializeItem(aInfo, TransferUtils::propertyHandler));
 		}
 	}
 
@@ -238,15 +239,15 @@ namespace webserver {
 		auto updatedProps = updateFlagsToPropertyIds(aUpdatedProperties);
 
 		view.onItemUpdated(aInfo, updatedProps);
-		if (subscriptionActive("transfer_updated")) {
-			send("transfer_updated", Serializer::serializePartialItem(aInfo, TransferUtils::propertyHandler, updatedProps));
+		if (subscriptionActive(updatedSubscription)) {
+			sendEvent(updatedSubscription, Serializer::serializePartialItem<EventJson>(aInfo, TransferUtils::propertyHandler, updatedProps));
 		}
 	}
 
 	void TransferApi::on(TransferInfoManagerListener::Removed, const TransferInfoPtr& aInfo) noexcept {
 		view.onItemRemoved(aInfo);
-		if (subscriptionActive("transfer_removed")) {
-			send("transfer_removed", Serializer::serializeItem(aInfo, TransferUtils::propertyHandler));
+		if (subscriptionActive(removedSubscription)) {
+			send(removedSubscription, Serializer::serializeItem(aInfo, TransferUtils::propertyHandler));
 		}
 	}
 
@@ -68,12 +68,16 @@ namespace webserver {
 
 		TimerPtr timer;
 
-		typedef ListViewController<TransferInfoPtr, TransferUtils::PROP_LAST> TransferListView;
+		typedef ListViewController<TransferInfoPtr, TransferUtils::PROP_LAST, &TransferUtils::accessors> TransferListView;
 		TransferListView view;
 
 		TransferInfoPtr getTransfer(ApiRequest& aRequest) const;
 		TransferInfo::List getTransfers() const noexcept;
 		static PropertyIdSet updateFlagsToPropertyIds(int aUpdatedProperties) noexcept;
+
+		const SubscriptionId addedSubscription = getSubscriptionId("transfer_added");
+		const SubscriptionId updatedSubscription = getSubscriptionId("transfer_updated");
+		const SubscriptionId removedSubscription = getSubscriptionId("transfer_removed");
 	};
 }
 
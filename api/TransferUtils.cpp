@@ -48,31 +48,12 @@ namespace webserver {
 		TransferUtils::getStringInfo, TransferUtils::getNumericInfo, TransferUtils::compareItems, TransferUtils::serializeProperty
 	};
 
-	std::string TransferUtils::getStringInfo(const TransferInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return aItem->getName();
-		case PROP_TARGET: return aItem->getTarget();
-		case PROP_TYPE: return Util::formatFileType(aItem->getTarget());
-		case PROP_STATUS: return aItem->getStatusString();
-		case PROP_IP: return aItem->getIp();
-		case PROP_USER: return Format::formatNicks(aItem->getHintedUser());
-		case PROP_ENCRYPTION: return aItem->getEncryption();
-		default: dcassert(0); return Util::emptyString;
-		}
+	const std::string& TransferUtils::getStringInfo(const TransferInfoPtr& aItem, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aItem, aPropertyName, buffer_);
 	}
 
 	double TransferUtils::getNumericInfo(const TransferInfoPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_SIZE: return (double)aItem->getSize();
-		case PROP_DOWNLOAD: return (double)aItem->isDownload();
-		case PROP_STATUS: return (double)aItem->getState();
-		case PROP_BYTES_TRANSFERRED: return (double)aItem->getBytesTransferred();
-		case PROP_TIME_STARTED: return (double)aItem->getStarted();
-		case PROP_SPEED: return (double)aItem->getSpeed();
-		case PROP_SECONDS_LEFT: return (double)aItem->getTimeLeft();
-		case PROP_QUEUE_ID: return (double)aItem->getQueueToken();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aItem, aPropertyName);
 	}
 
 	int TransferUtils::compareItems(const TransferInfoPtr& a, const TransferInfoPtr& b, int aPropertyName) noexcept {
@@ -20,6 +20,7 @@
 #define DCPLUSPLUS_DCPP_TRANSFERUTILS_H
 
 #include <api/common/Property.h>
+#include <api/common/Format.h>
 
 #include <airdcpp/TransferInfo.h>
 
@@ -53,12 +54,31 @@ namespace webserver {
 
 		static int compareItems(const TransferInfoPtr& a, const TransferInfoPtr& b, int aPropertyName) noexcept;
 
-		static std::string getStringInfo(const TransferInfoPtr& aItem, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const TransferInfoPtr& aItem, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const TransferInfoPtr& aItem, int aPropertyName) noexcept;
 		static string serializeStateKey(TransferInfo::ItemState aState) noexcept;
-	private:
 
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<TransferInfoPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getName(), buffer_); }, nullptr },
+			{ PROP_TARGET, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getTarget(), buffer_); }, nullptr },
+			{ PROP_TYPE, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(Util::formatFileType(aItem->getTarget()), buffer_); }, nullptr },
+			{ PROP_DOWNLOAD, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->isDownload(); } },
+			{ PROP_SIZE, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getSize(); } },
+			{ PROP_STATUS, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getStatusString(), buffer_); }, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getState(); } },
+			{ PROP_BYTES_TRANSFERRED, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getBytesTransferred(); } },
+			{ PROP_USER, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(Format::formatNicks(aItem->getHintedUser()), buffer_); }, nullptr },
+			{ PROP_TIME_STARTED, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getStarted(); } },
+			{ PROP_SPEED, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getSpeed(); } },
+			{ PROP_SECONDS_LEFT, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getTimeLeft(); } },
+			{ PROP_IP, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getIp(), buffer_); }, nullptr },
+			{ PROP_FLAGS, nullptr, nullptr },
+			{ PROP_ENCRYPTION, [](const TransferInfoPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getEncryption(), buffer_); }, nullptr },
+			{ PROP_QUEUE_ID, nullptr, [](const TransferInfoPtr& aItem) -> double { return (double)aItem->getQueueToken(); } },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(TransferUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
@@ -55,8 +55,9 @@ namespace webserver {
 	}
 
 	api_return WebUserApi::handleGetUsers(ApiRequest& aRequest) {
-		auto j = Serializer::serializeItemList(WebUserUtils::propertyHandler, getUsers());
-		aRequest.setResponseBody(j);
+		JsonWriter writer;
+		Serializer::serializeItemList(writer, WebUserUtils::propertyHandler, getUsers());
+		aRequest.setSerializedResponseBody(std::move(writer));
 		return websocketpp::http::status_code::ok;
 	}
 
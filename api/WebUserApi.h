@@ -43,7 +43,7 @@ namespace webserver {
 		void on(WebUserManagerListener::UserUpdated, const WebUserPtr& aUser) noexcept override;
 		void on(WebUserManagerListener::UserRemoved, const WebUserPtr& aUser) noexcept override;
 
-		typedef ListViewController<WebUserPtr, WebUserUtils::PROP_LAST> RootView;
+		typedef ListViewController<WebUserPtr, WebUserUtils::PROP_LAST, &WebUserUtils::accessors> RootView;
 		RootView view;
 
 		WebUserManager& um;
@@ -81,17 +81,10 @@ namespace webserver {
 		return 0;
 	}
 
-	std::string WebUserUtils::getStringInfo(const WebUserPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_NAME: return aItem->getUserName();
-		default: dcassert(0); return 0;
-		}
+	const std::string& WebUserUtils::getStringInfo(const WebUserPtr& aItem, int aPropertyName, std::string& buffer_) noexcept {
+		return getPropertyString(accessors, aItem, aPropertyName, buffer_);
 	}
 	double WebUserUtils::getNumericInfo(const WebUserPtr& aItem, int aPropertyName) noexcept {
-		switch (aPropertyName) {
-		case PROP_LAST_LOGIN: return (double)aItem->getLastLogin();
-		case PROP_ACTIVE_SESSIONS: return (double)aItem->getActiveSessions();
-		default: dcassert(0); return 0;
-		}
+		return getPropertyNumber(accessors, aItem, aPropertyName);
 	}
 }
\ No newline at end of file
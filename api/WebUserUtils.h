@@ -46,9 +46,19 @@ namespace webserver {
 		static bool filterItem(const WebUserPtr& aItem, int aPropertyName, const StringMatch& aTextMatcher, double aNumericMatcher) noexcept;
 
 		static int compareItems(const WebUserPtr& a, const WebUserPtr& b, int aPropertyName) noexcept;
-		static std::string getStringInfo(const WebUserPtr& a, int aPropertyName) noexcept;
+		static const std::string& getStringInfo(const WebUserPtr& a, int aPropertyName, std::string& buffer_) noexcept;
 		static double getNumericInfo(const WebUserPtr& a, int aPropertyName) noexcept;
+
+		// Text and numeric property values for filtering and sorting (in the order of the property IDs)
+		static constexpr PropertyAccessorTable<WebUserPtr, PROP_LAST> accessors = {{
+			{ PROP_NAME, [](const WebUserPtr& aItem, string& buffer_) -> const string& { return toPropertyString(aItem->getUserName(), buffer_); }, nullptr },
+			{ PROP_PERMISSIONS, nullptr, nullptr },
+			{ PROP_ACTIVE_SESSIONS, nullptr, [](const WebUserPtr& aItem) -> double { return (double)aItem->getActiveSessions(); } },
+			{ PROP_LAST_LOGIN, nullptr, [](const WebUserPtr& aItem) -> double { return (double)aItem->getLastLogin(); } },
+		}};
 	};
+
+	static_assert(isValidAccessorTable(WebUserUtils::accessors), "The accessors must be listed in the order of the property IDs");
 }
 
 #endif
\ No newline at end of file
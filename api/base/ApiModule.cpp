@@ -18,6 +18,7 @@
 
 #include "stdinc.h"
 
+#include <web-server/MessageEncoding.h>
 #include <web-server/WebSocket.h>
 #include <web-server/WebServerManager.h>
 #include <web-server/WebUserManager.h>
@@ -96,6 +97,11 @@ namespace webserver {
 			return websocketpp::http::status_code::forbidden;
 		}
 
+		if (handler->method != METHOD_FORWARD) {
+			// Forwarding handlers will route the request further
+			aRequest.parseRequestBody();
+		}
+
 		return handler->f(aRequest);
 	}
 
@@ -131,7 +137,7 @@ namespace webserver {
 		socket = WebServerManager::getInstance()->getSocket(aSession->getId());
 
 		for (const auto& s: aSubscriptions) {
-			subscriptions.emplace(s, false);
+			SubscribableApiModule::createSubscription(s);
 		}
 
 		aSession->addListener(this);
@@ -145,14 +151,28 @@ namespace webserver {
 		socket = nullptr;
 	}
 
+	SubscribableApiModule::SubscriptionId SubscribableApiModule::createSubscription(const string& aSubscription) noexcept {
+		dcassert(!subscriptionExists(aSubscription));
+
+		auto id = subscriptions.size();
+		subscriptions.push_back({ aSubscription, formatEventPrefix(aSubscription) });
+		subscriptionIds.emplace(aSubscription, id);
+
+		if (id / 64 >= subscriptionStates.size()) {
+			subscriptionStates.emplace_back(0);
+		}
+
+		return id;
+	}
+
 	void SubscribableApiModule::on(SessionListener::SocketConnected, const WebSocketPtr& aSocket) noexcept {
 		socket = aSocket;
 	}
 
 	void SubscribableApiModule::on(SessionListener::SocketDisconnected) noexcept {
 		// Disable all subscriptions
-		for (auto& s : subscriptions) {
-			s.second = false;
+		for (auto& s : subscriptionStates) {
+			s.store(0, std::memory_order_relaxed);
 		}
 
 		socket = nullptr;
@@ -184,6 +204,38 @@ namespace webserver {
 		return websocketpp::http::status_code::not_found;
 	}
 
+	string SubscribableApiModule::formatEventPrefix(const string& aSubscription) {
+		JsonWriter writer;
+		writer.startObject();
+		writer.writeKey("event");
+		writer.writeString(aSubscription);
+		return writer.release() + ",";
+	}
+
+	string SubscribableApiModule::formatEventMessage(const string& aEventPrefix, const JsonWriter& aData) const noexcept {
+		string message;
+		message.reserve(aEventPrefix.size() + eventEnvelopeFields.size() + aData.size() + 10);
+
+		message += aEventPrefix;
+		message += eventEnvelopeFields;
+		message += "\"data\":";
+		message += aData.empty() ? "null" : aData.str();
+		message += '}';
+		return message;
+	}
+
+	string SubscribableApiModule::formatEventMessage(SubscriptionId aSubscription, const JsonWriter& aData) const noexcept {
+		return formatEventMessage(subscriptions[aSubscription].eventPrefix, aData);
+	}
+
+	bool SubscribableApiModule::sendEventMessage(const string& aEventPrefix, const JsonWriter& aData) noexcept {
+		return sendFrame(std::make_shared<const MessageFrame>(formatEventMessage(aEventPrefix, aData)));
+	}
+
+	bool SubscribableApiModule::hasSubscriptionAccess() const noexcept {
+		return session->getUser()->hasPermission(subscriptionAccess);
+	}
+
 	bool SubscribableApiModule::send(const json& aJson) {
 		// Ensure that the socket won't be deleted while sending the message...
 		auto s = socket;
@@ -201,18 +253,99 @@ namespace webserver {
 		return true;
 	}
 
+	bool SubscribableApiModule::send(SubscriptionId aSubscription, const json& aData) {
+		JsonWriter writer;
+		try {
+			writer.writeJson(aData);
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return false;
+		}
+
+		return sendSerialized(aSubscription, writer);
+	}
+
 	bool SubscribableApiModule::send(const string& aSubscription, const json& aData) {
-		return send({
-			{ "event", aSubscription },
-			{ "data", aData },
-		});
+		JsonWriter writer;
+		try {
+			writer.writeJson(aData);
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return false;
+		}
+
+		return sendSerialized(aSubscription, writer);
+	}
+
+	bool SubscribableApiModule::sendSerialized(SubscriptionId aSubscription, const JsonWriter& aData) {
+		return sendEventMessage(subscriptions[aSubscription].eventPrefix, aData);
+	}
+
+	bool SubscribableApiModule::sendSerialized(const string& aSubscription, const JsonWriter& aData) {
+		auto s = subscriptionIds.find(aSubscription);
+		if (s != subscriptionIds.end()) {
+			return sendSerialized(s->second, aData);
+		}
+
+		// Events without a subscription (such as list view updates)
+		string prefix;
+		try {
+			prefix = formatEventPrefix(aSubscription);
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return false;
+		}
+
+		return sendEventMessage(prefix, aData);
 	}
 
-	bool SubscribableApiModule::maybeSend(const string& aSubscription, JsonCallback aCallback) {
+	bool SubscribableApiModule::sendFrame(const MessageFramePtr& aFrame) noexcept {
+		auto s = socket;
+		if (!s) {
+			return false;
+		}
+
+		s->sendEvent(aFrame);
+		return true;
+	}
+
+	bool SubscribableApiModule::maybeSend(SubscriptionId aSubscription, const JsonCallback& aCallback) {
 		if (!subscriptionActive(aSubscription)) {
 			return false;
 		}
 
 		return send(aSubscription, aCallback());
 	}
+
+	bool SubscribableApiModule::maybeSend(const string& aSubscription, const JsonCallback& aCallback) {
+		return maybeSend(getSubscriptionId(aSubscription), aCallback);
+	}
+
+	bool SubscribableApiModule::sendEvent(SubscriptionId aSubscription, EventJson&& aData) {
+		JsonWriter writer;
+		try {
+			writer.writeJson(aData);
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return false;
+		}
+
+		return sendSerialized(aSubscription, writer);
+	}
+
+	bool SubscribableApiModule::sendEvent(const string& aSubscription, EventJson&& aData) {
+		return sendEvent(getSubscriptionId(aSubscription), std::move(aData));
+	}
+
+	bool SubscribableApiModule::maybeSendEvent(SubscriptionId aSubscription, const EventJsonCallback& aCallback) {
+		if (!subscriptionActive(aSubscription)) {
+			return false;
+		}
+
+		return sendEvent(aSubscription, aCallback());
+	}
+
+	bool SubscribableApiModule::maybeSendEvent(const string& aSubscription, const EventJsonCallback& aCallback) {
+		return maybeSendEvent(getSubscriptionId(aSubscription), aCallback);
+	}
 }
\ No newline at end of file
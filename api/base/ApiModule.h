@@ -21,8 +21,11 @@
 
 #include <web-server/Access.h>
 #include <web-server/ApiRequest.h>
+#include <web-server/JsonArena.h>
 #include <web-server/SessionListener.h>
 
+#include <atomic>
+
 namespace webserver {
 	using boost::regex;
 
@@ -118,41 +121,90 @@ namespace webserver {
 		SubscribableApiModule(Session* aSession, Access aSubscriptionAccess, const StringList& aSubscriptions);
 		virtual ~SubscribableApiModule();
 
-		typedef std::map<const string, bool> SubscriptionMap;
+		// Subscriptions are identified by their creation order
+		// The IDs should be resolved when constructing the module so that the names don't need to be looked up for each event
+		typedef size_t SubscriptionId;
+		typedef std::map<string, SubscriptionId> SubscriptionIdMap;
 
 		virtual bool send(const json& aJson);
-		virtual bool send(const string& aSubscription, const json& aJson);
+
+		bool send(SubscriptionId aSubscription, const json& aJson);
+		bool send(const string& aSubscription, const json& aJson);
+
+		// Send event data that has been serialized with a writer
+		bool sendSerialized(SubscriptionId aSubscription, const JsonWriter& aData);
+		bool sendSerialized(const string& aSubscription, const JsonWriter& aData);
+
+		// Send an event message that may be shared with other modules
+		bool sendFrame(const MessageFramePtr& aFrame) noexcept;
+
+		// Returns the full event message with the envelope of this module
+		string formatEventMessage(SubscriptionId aSubscription, const JsonWriter& aData) const noexcept;
 
 		typedef std::function<json()> JsonCallback;
-		virtual bool maybeSend(const string& aSubscription, JsonCallback aCallback);
+		bool maybeSend(SubscriptionId aSubscription, const JsonCallback& aCallback);
+		bool maybeSend(const string& aSubscription, const JsonCallback& aCallback);
+
+		// Send event data allocated from the JSON arena of the current thread
+		// The data should be a temporary so that the arena gets reset after the event has been sent
+		bool sendEvent(SubscriptionId aSubscription, EventJson&& aData);
+		bool sendEvent(const string& aSubscription, EventJson&& aData);
+
+		typedef std::function<EventJson()> EventJsonCallback;
+		bool maybeSendEvent(SubscriptionId aSubscription, const EventJsonCallback& aCallback);
+		bool maybeSendEvent(const string& aSubscription, const EventJsonCallback& aCallback);
+
+		// The subscription must exist
+		SubscriptionId getSubscriptionId(const string& aSubscription) const noexcept {
+			auto s = subscriptionIds.find(aSubscription);
+			dcassert(s != subscriptionIds.end());
+			return s->second;
+		}
 
-		// All custom async tasks should be run inside this to
-		// ensure that the session won't get deleted
+		const string& getSubscriptionName(SubscriptionId aSubscription) const noexcept {
+			return subscriptions[aSubscription].name;
+		}
 
-		virtual void setSubscriptionState(const string& aSubscription, bool active) noexcept {
-			subscriptions[aSubscription] = active;
+		size_t getSubscriptionCount() const noexcept {
+			return subscriptions.size();
 		}
 
-		virtual bool subscriptionActive(const string& aSubscription) const noexcept {
-			auto s = subscriptions.find(aSubscription);
-			dcassert(s != subscriptions.end());
-			return s->second;
+		void setSubscriptionState(const string& aSubscription, bool aActive) noexcept {
+			setSubscriptionState(getSubscriptionId(aSubscription), aActive);
+		}
+
+		void setSubscriptionState(SubscriptionId aSubscription, bool aActive) noexcept {
+			auto& word = subscriptionStates[aSubscription / 64];
+			auto mask = static_cast<uint64_t>(1) << (aSubscription % 64);
+			if (aActive) {
+				word.fetch_or(mask, std::memory_order_relaxed);
+			} else {
+				word.fetch_and(~mask, std::memory_order_relaxed);
+			}
 		}
 
-		virtual bool subscriptionExists(const string& aSubscription) const noexcept {
-			auto i = subscriptions.find(aSubscription);
-			return i != subscriptions.end();
+		virtual bool subscriptionActive(SubscriptionId aSubscription) const noexcept {
+			return (subscriptionStates[aSubscription / 64].load(std::memory_order_relaxed) >> (aSubscription % 64)) & 1;
 		}
 
-		virtual void createSubscription(const string& aSubscription) noexcept {
-			dcassert(subscriptions.find(aSubscription) == subscriptions.end());
-			subscriptions[aSubscription];
+		bool subscriptionActive(const string& aSubscription) const noexcept {
+			return subscriptionActive(getSubscriptionId(aSubscription));
 		}
 
+		bool subscriptionExists(const string& aSubscription) const noexcept {
+			return subscriptionIds.find(aSubscription) != subscriptionIds.end();
+		}
+
+		// Subscriptions may only be created when constructing the module
+		virtual SubscriptionId createSubscription(const string& aSubscription) noexcept;
+
 		Access getSubscriptionAccess() const noexcept {
 			return subscriptionAccess;
 		}
 
+		// Permissions of the session user may change after subscribing
+		bool hasSubscriptionAccess() const noexcept;
+
 		const WebSocketPtr& getSocket() const noexcept {
 			return socket;
 		}
@@ -164,9 +216,32 @@ namespace webserver {
 
 		virtual api_return handleSubscribe(ApiRequest& aRequest);
 		virtual api_return handleUnsubscribe(ApiRequest& aRequest);
+
+		// Serialized fields that are added in the envelope of each event (must end with a comma)
+		void setEventEnvelopeFields(const string& aSerializedFields) noexcept {
+			eventEnvelopeFields = aSerializedFields;
+		}
 	private:
+		struct Subscription {
+			string name;
+
+			// Start of the event message ({"event":"name",)
+			string eventPrefix;
+		};
+
+		bool sendEventMessage(const string& aEventPrefix, const JsonWriter& aData) noexcept;
+		string formatEventMessage(const string& aEventPrefix, const JsonWriter& aData) const noexcept;
+		static string formatEventPrefix(const string& aSubscription);
+
 		WebSocketPtr socket = nullptr;
-		SubscriptionMap subscriptions;
+
+		std::deque<Subscription> subscriptions;
+		SubscriptionIdMap subscriptionIds;
+
+		// Active state bits (indexed by subscription ID)
+		std::deque<std::atomic<uint64_t>> subscriptionStates;
+
+		string eventEnvelopeFields;
 	};
 
 	typedef std::unique_ptr<ApiModule> HandlerPtr;
@@ -0,0 +1,109 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <api/base/EventFanout.h>
+
+#include <web-server/MessageEncoding.h>
+
+
+namespace webserver {
+	void EventFanout::addModule(SubscribableApiModule* aModule) noexcept {
+		auto id = aModule->getSubscriptionId(subscription);
+
+		WLock l(cs);
+		dcassert(find_if(receivers.begin(), receivers.end(), [&](const Receiver& r) { return r.module == aModule; }) == receivers.end());
+		receivers.push_back({ aModule, id });
+	}
+
+	void EventFanout::removeModule(SubscribableApiModule* aModule) noexcept {
+		WLock l(cs);
+		receivers.erase(remove_if(receivers.begin(), receivers.end(), [&](const Receiver& r) { return r.module == aModule; }), receivers.end());
+	}
+
+	EventFanout::ReceiverList EventFanout::getActiveReceivers() const noexcept {
+		ReceiverList ret;
+		for (const auto& r: receivers) {
+			if (r.module->subscriptionActive(r.subscription) && r.module->hasSubscriptionAccess()) {
+				ret.push_back(r);
+			}
+		}
+
+		return ret;
+	}
+
+	size_t EventFanout::send(const json& aData) noexcept {
+		return maybeSend([&] { return aData; });
+	}
+
+	size_t EventFanout::sendEvent(EventJson&& aData) noexcept {
+		return maybeSendEvent([&] { return std::move(aData); });
+	}
+
+	size_t EventFanout::maybeSend(const SubscribableApiModule::JsonCallback& aCallback) noexcept {
+		RLock l(cs);
+		auto active = getActiveReceivers();
+		if (active.empty()) {
+			return 0;
+		}
+
+		JsonWriter writer;
+		try {
+			writer.writeJson(aCallback());
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return 0;
+		}
+
+		return sendFrame(active, writer);
+	}
+
+	size_t EventFanout::maybeSendEvent(const SubscribableApiModule::EventJsonCallback& aCallback) noexcept {
+		RLock l(cs);
+		auto active = getActiveReceivers();
+		if (active.empty()) {
+			return 0;
+		}
+
+		JsonWriter writer;
+		try {
+			writer.writeJson(aCallback());
+		} catch (const std::exception&) {
+			// Ignore JSON errors...
+			return 0;
+		}
+
+		return sendFrame(active, writer);
+	}
+
+	size_t EventFanout::sendFrame(const ReceiverList& aReceivers, const JsonWriter& aData) noexcept {
+		// The envelope is identical for all modules
+		auto frame = std::make_shared<const MessageFrame>(aReceivers.front().module->formatEventMessage(aReceivers.front().subscription, aData));
+
+		size_t sent = 0;
+		for (const auto& r: aReceivers) {
+			dcassert(r.module->formatEventMessage(r.subscription, aData) == frame->getText());
+			if (r.module->sendFrame(frame)) {
+				sent++;
+			}
+		}
+
+		return sent;
+	}
+}
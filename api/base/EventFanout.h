@@ -0,0 +1,108 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_EVENT_FANOUT_H
+#define DCPLUSPLUS_DCPP_EVENT_FANOUT_H
+
+#include "stdinc.h"
+
+#include <api/base/ApiModule.h>
+
+#include <airdcpp/CriticalSection.h>
+
+
+namespace webserver {
+	// Delivers an event that is identical for all sessions
+	//
+	// The event data is serialized only once into an immutable frame that is then queued to the socket
+	// of each added module that has the subscription enabled. Modules must be removed before they are destroyed.
+	class EventFanout {
+	public:
+		explicit EventFanout(const string& aSubscription) noexcept : subscription(aSubscription) { }
+
+		void addModule(SubscribableApiModule* aModule) noexcept;
+		void removeModule(SubscribableApiModule* aModule) noexcept;
+
+		// Each method returns the number of modules that the event was sent to
+		size_t send(const json& aData) noexcept;
+		size_t sendEvent(EventJson&& aData) noexcept;
+
+		size_t maybeSend(const SubscribableApiModule::JsonCallback& aCallback) noexcept;
+		size_t maybeSendEvent(const SubscribableApiModule::EventJsonCallback& aCallback) noexcept;
+
+		const string& getSubscription() const noexcept {
+			return subscription;
+		}
+
+		EventFanout(EventFanout&) = delete;
+		EventFanout& operator=(EventFanout&) = delete;
+	private:
+		struct Receiver {
+			SubscribableApiModule* module;
+			SubscribableApiModule::SubscriptionId subscription;
+		};
+
+		typedef vector<Receiver> ReceiverList;
+
+		// Returns the receivers that have the subscription enabled and are still allowed to access it
+		// The lock must be held while using the returned modules
+		ReceiverList getActiveReceivers() const noexcept;
+
+		static size_t sendFrame(const ReceiverList& aReceivers, const JsonWriter& aData) noexcept;
+
+		const string subscription;
+
+		ReceiverList receivers;
+		mutable SharedMutex cs;
+	};
+
+	// Keeps a single shared instance per key for as long as it's being referenced
+	template<class KeyT, class T>
+	class SharedInstanceMap {
+	public:
+		typedef shared_ptr<T> Ptr;
+
+		template<class... ArgT>
+		Ptr get(const KeyT& aKey, ArgT&&... aArgs) noexcept {
+			Lock l(cs);
+
+			// Remove unused instances
+			for (auto i = instances.begin(); i != instances.end();) {
+				if (i->second.expired()) {
+					i = instances.erase(i);
+				} else {
+					++i;
+				}
+			}
+
+			auto& instance = instances[aKey];
+			auto ret = instance.lock();
+			if (!ret) {
+				ret = std::make_shared<T>(std::forward<ArgT>(aArgs)...);
+				instance = ret;
+			}
+
+			return ret;
+		}
+	private:
+		map<KeyT, std::weak_ptr<T>> instances;
+		CriticalSection cs;
+	};
+}
+
+#endif
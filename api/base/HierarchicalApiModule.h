@@ -54,6 +54,7 @@ namespace webserver {
 			// Request forwarder
 			METHOD_HANDLER(Access::ANY, METHOD_FORWARD, (aParamMatcher), Type::handleSubModuleRequest);
 
+			childSubscriptionOffset = this->getSubscriptionCount();
 			for (const auto& s: aChildSubscription) {
 				SubscribableApiModule::createSubscription(s);
 			}
@@ -81,8 +82,19 @@ namespace webserver {
 			subModulesCopy.clear();
 		}
 
-		void createSubscription(const string&) noexcept override {
+		SubscribableApiModule::SubscriptionId createSubscription(const string&) noexcept override {
 			dcassert(0);
+			return 0;
+		}
+
+		// Check whether a child subscription has been enabled for all entities
+		// Child modules use the same IDs for the child subscriptions (starting from zero)
+		bool childSubscriptionActive(SubscribableApiModule::SubscriptionId aChildSubscription) const noexcept {
+			return this->subscriptionActive(childSubscriptionOffset + aChildSubscription);
+		}
+
+		const string& getChildSubscriptionName(SubscribableApiModule::SubscriptionId aChildSubscription) const noexcept {
+			return this->getSubscriptionName(childSubscriptionOffset + aChildSubscription);
 		}
 
 		// Forward request to a submodule
@@ -168,6 +180,8 @@ namespace webserver {
 		typedef map<IdType, typename ItemType::Ptr> SubModuleMap;
 		SubModuleMap subModules;
 
+		SubscribableApiModule::SubscriptionId childSubscriptionOffset = 0;
+
 		const IdConvertF idConvertF;
 		const ChildSerializeF childSerializeF;
 		const string paramId;
@@ -181,27 +195,22 @@ namespace webserver {
 		// aId = ID of the entity owning this module
 		// Will inherit access from the parent module
 		SubApiModule(ParentType* aParentModule, const IdJsonType& aJsonId, const StringList& aSubscriptions) :
-			SubscribableApiModule(aParentModule->getSession(), aParentModule->getSubscriptionAccess(), aSubscriptions), parentModule(aParentModule), jsonId(aJsonId) { }
+			SubscribableApiModule(aParentModule->getSession(), aParentModule->getSubscriptionAccess(), aSubscriptions), parentModule(aParentModule) {
 
-		bool send(const string& aSubscription, const json& aJson) override {
-			return SubscribableApiModule::send({
-				{ "event", aSubscription },
-				{ "data", aJson },
-				{ "id", jsonId }
-			});
-		}
-
-		bool maybeSend(const string& aSubscription, SubscribableApiModule::JsonCallback aCallback) override {
-			if (!subscriptionActive(aSubscription)) {
-				return false;
+#ifdef _DEBUG
+			for (size_t i = 0; i < aSubscriptions.size(); ++i) {
+				dcassert(aParentModule->getChildSubscriptionName(i) == aSubscriptions[i]);
 			}
+#endif
 
-			return send(aSubscription, aCallback());
+			// Identify the entity in all events
+			setEventEnvelopeFields("\"id\":" + JsonWriter::dump(json(aJsonId)) + ",");
 		}
 
-		bool subscriptionActive(const string& aSubscription) const noexcept override {
+		using SubscribableApiModule::subscriptionActive;
+		bool subscriptionActive(SubscriptionId aSubscription) const noexcept override {
 			// Enabled across all entities?
-			if (parentModule->subscriptionActive(aSubscription)) {
+			if (parentModule->childSubscriptionActive(aSubscription)) {
 				return true;
 			}
 
@@ -217,8 +226,9 @@ namespace webserver {
 
 		virtual IdType getId() const noexcept = 0;
 
-		void createSubscription(const string&) noexcept override {
+		SubscriptionId createSubscription(const string&) noexcept override {
 			dcassert(0);
+			return 0;
 		}
 
 		void addAsyncTask(CallBack&& aTask) override {
@@ -258,8 +268,6 @@ namespace webserver {
 
 
 		ParentType* parentModule;
-
-		const IdJsonType jsonId;
 	};
 }
 
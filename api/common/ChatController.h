@@ -33,7 +33,11 @@ namespace webserver {
 	public:
 		typedef typename std::function<const T&()> ChatGetterF;
 		ChatController(SubscribableApiModule* aModule, const ChatGetterF& aChatF, const string& aSubscriptionId, Access aViewPermission, Access aEditPermission, Access aSendPermission) :
-			module(aModule), subscriptionId(aSubscriptionId), chatF(aChatF)
+			module(aModule), chatF(aChatF),
+			messageSubscription(aModule->getSubscriptionId(aSubscriptionId + "_message")),
+			statusSubscription(aModule->getSubscriptionId(aSubscriptionId + "_status")),
+			textCommandSubscription(aModule->getSubscriptionId(aSubscriptionId + "_text_command")),
+			updatedSubscription(aModule->getSubscriptionId(aSubscriptionId + "_updated"))
 		{
 			MODULE_METHOD_HANDLER(aModule, aSendPermission, METHOD_POST, (EXACT_PARAM("chat_message")), ChatController::handlePostChatMessage);
 			MODULE_METHOD_HANDLER(aModule, aEditPermission, METHOD_POST, (EXACT_PARAM("status_message")), ChatController::handlePostStatusMessage);
@@ -46,23 +50,21 @@ namespace webserver {
 		void onChatMessage(const ChatMessagePtr& aMessage) noexcept {
 			onMessagesUpdated();
 
-			auto s = toListenerName("message");
-			if (!module->subscriptionActive(s)) {
+			if (!module->subscriptionActive(messageSubscription)) {
 				return;
 			}
 
-			module->send(s, Serializer::serializeChatMessage(aMessage));
+			module->send(messageSubscription, Serializer::serializeChatMessage(aMessage));
 		}
 
 		void onStatusMessage(const LogMessagePtr& aMessage) noexcept {
 			onMessagesUpdated();
 
-			auto s = toListenerName("status");
-			if (!module->subscriptionActive(s)) {
+			if (!module->subscriptionActive(statusSubscription)) {
 				return;
 			}
 
-			module->send(s, Serializer::serializeLogMessage(aMessage));
+			module->send(statusSubscription, Serializer::serializeLogMessage(aMessage));
 		}
 
 		void onMessagesUpdated() {
@@ -70,8 +72,7 @@ namespace webserver {
 		}
 
 		void onChatCommand(const OutgoingChatMessage& aMessage) {
-			auto s = toListenerName("text_command");
-			if (!module->subscriptionActive(s)) {
+			if (!module->subscriptionActive(textCommandSubscription)) {
 				return;
 			}
 
@@ -87,7 +88,7 @@ namespace webserver {
 
 			tokens.pop_front();
 
-			module->send(s, {
+			module->send(textCommandSubscription, {
 				{ "command", command.substr(1) },
 				{ "args", tokens },
 				{ "permissions",  Serializer::serializePermissions(parseMessageAuthorAccess(aMessage)) },
@@ -95,12 +96,11 @@ namespace webserver {
 		}
 	private:
 		void sendUnread() noexcept {
-			auto s = toListenerName("updated");
-			if (!module->subscriptionActive(s)) {
+			if (!module->subscriptionActive(updatedSubscription)) {
 				return;
 			}
 
-			module->send(s, {
+			module->send(updatedSubscription, {
 				{ "message_counts",  Serializer::serializeCacheInfo(chatF()->getCache(), Serializer::serializeUnreadChat) },
 			});
 		}
@@ -167,13 +167,13 @@ namespace webserver {
 			return websocketpp::http::status_code::ok;
 		}
 
-		string toListenerName(const string& aSubscription) {
-			return subscriptionId + "_" + aSubscription;
-		}
-
 		ChatGetterF chatF;
-		string subscriptionId;
 		SubscribableApiModule* module;
+
+		const SubscribableApiModule::SubscriptionId messageSubscription;
+		const SubscribableApiModule::SubscriptionId statusSubscription;
+		const SubscribableApiModule::SubscriptionId textCommandSubscription;
+		const SubscribableApiModule::SubscriptionId updatedSubscription;
 	};
 }
 
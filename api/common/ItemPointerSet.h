@@ -0,0 +1,110 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_ITEM_POINTER_SET_H
+#define DCPLUSPLUS_DCPP_ITEM_POINTER_SET_H
+
+
+namespace webserver {
+
+	// Set of item addresses for fast membership checks of small item lists (such as the viewport items)
+	//
+	// Uses open addressing with linear probing. The table is reused when the content is replaced,
+	// so no memory is allocated once the table has grown to the needed size.
+	template<class T>
+	class ItemPointerSet {
+	public:
+		// Replace the content
+		template<class ContainerT>
+		void assign(const ContainerT& aItems) {
+			// Keep the load factor below 0.5
+			size_t tableSize = 16;
+			while (tableSize < aItems.size() * 2) {
+				tableSize *= 2;
+			}
+
+			if (table.size() < tableSize) {
+				table.resize(tableSize);
+			}
+
+			std::fill(table.begin(), table.end(), nullptr);
+			count = 0;
+
+			for (const auto& item : aItems) {
+				insert(item);
+			}
+		}
+
+		void clear() noexcept {
+			std::fill(table.begin(), table.end(), nullptr);
+			count = 0;
+		}
+
+		size_t size() const noexcept {
+			return count;
+		}
+
+		bool contains(const T& aItem) const noexcept {
+			if (count == 0) {
+				return false;
+			}
+
+			auto key = getKey(aItem);
+			for (auto i = getSlot(aItem);; i = (i + 1) & (table.size() - 1)) {
+				if (table[i] == key) {
+					return true;
+				}
+
+				if (!table[i]) {
+					return false;
+				}
+			}
+		}
+	private:
+		void insert(const T& aItem) noexcept {
+			auto key = getKey(aItem);
+			for (auto i = getSlot(aItem);; i = (i + 1) & (table.size() - 1)) {
+				if (table[i] == key) {
+					return;
+				}
+
+				if (!table[i]) {
+					table[i] = key;
+					count++;
+					return;
+				}
+			}
+		}
+
+		static const void* getKey(const T& aItem) noexcept {
+			return static_cast<const void*>(&*aItem);
+		}
+
+		// Item addresses are aligned so the bits need to be mixed before masking
+		size_t getSlot(const T& aItem) const noexcept {
+			auto hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(getKey(aItem))) * 0x9E3779B97F4A7C15ULL;
+			hash ^= hash >> 32;
+			return static_cast<size_t>(hash) & (table.size() - 1);
+		}
+
+		vector<const void*> table;
+		size_t count = 0;
+	};
+}
+
+#endif
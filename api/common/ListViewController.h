@@ -20,21 +20,33 @@
 #define DCPLUSPLUS_DCPP_LISTVIEW_H
 
 #include <web-server/JsonUtil.h>
+#include <web-server/ParallelUtil.h>
 #include <web-server/SessionListener.h>
 #include <web-server/Timer.h>
 #include <web-server/WebServerManager.h>
 
 #include <airdcpp/TimerManager.h>
 
+#include <deque>
+#include <unordered_set>
+
 #include <api/base/ApiModule.h>
+#include <api/common/ItemPointerSet.h>
 #include <api/common/PropertyFilter.h>
+#include <api/common/PropertyFragmentCache.h>
+#include <api/common/RankedItemList.h>
 #include <api/common/Serializer.h>
+#include <api/common/SortKeyCache.h>
 #include <api/common/ViewTasks.h>
 
 namespace webserver {
 
-	template<class T, int PropertyCount>
+	// Property values are read through the accessor table when one is given (the item handler is used otherwise)
+	template<class T, int PropertyCount, const PropertyAccessorTable<T, PropertyCount>* Accessors = nullptr>
 	class ListViewController : private SessionListener {
+		static_assert(static_cast<size_t>(PropertyCount) <= PropertyIdSet::MAX_COUNT, "Too many properties for PropertyIdSet");
+
+		typedef PropertyValues<T, PropertyCount, Accessors> Values;
 	public:
 		typedef typename PropertyItemHandler<T>::ItemList ItemList;
 		typedef typename PropertyItemHandler<T>::ItemListFunction ItemListF;
@@ -43,7 +55,7 @@ namespace webserver {
 		// Use the short default update interval for lists that can be edited by the users
 		// Larger lists with lots of updates and non-critical response times should specify a longer interval
 		ListViewController(const string& aViewName, SubscribableApiModule* aModule, const PropertyItemHandler<T>& aItemHandler, ItemListF aItemListF, time_t aUpdateInterval = 200) :
-			module(aModule), viewName(aViewName), itemHandler(aItemHandler), itemListF(aItemListF),
+			module(aModule), viewName(aViewName), itemHandler(aItemHandler), sortKeys(aItemHandler), itemListF(aItemListF),
 			timer(aModule->getTimer([this] { runTasks(); }, aUpdateInterval))
 		{
 			aModule->getSession()->addListener(this);
@@ -63,6 +75,11 @@ namespace webserver {
 			module->getSession()->removeListener(this);
 
 			timer->stop(true);
+
+			// Views of entities (such as hubs and filelists) are destroyed without stopping them
+			// The shared values wouldn't be invalidated anymore
+			RLock l(cs);
+			getFragmentCache().remove(sourceItems);
 		}
 
 		void stop() noexcept {
@@ -94,8 +111,10 @@ namespace webserver {
 		}
 
 		void onItemUpdated(const T& aItem, const PropertyIdSet& aUpdatedProperties) {
+			// Inactive views have removed their items from the shared cache
 			if (!active) return;
 
+			getFragmentCache().invalidate(aItem, aUpdatedProperties);
 			tasks.updateItem(aItem, aUpdatedProperties);
 		}
 
@@ -177,9 +196,11 @@ namespace webserver {
 		template<typename FilterT = PropertyFilter::Ptr, typename MatcherT>
 		bool matchesFilter(const T& aItem, const MatcherT& aMatcher) {
 			return PropertyFilter::Matcher<FilterT>::match(aMatcher,
-				[&](size_t aProperty) { return itemHandler.numberF(aItem, aProperty); },
-				[&](size_t aProperty) { return itemHandler.stringF(aItem, aProperty); },
-				[&](size_t aProperty, const StringMatch& aStringMatcher, double aNumericMatcher) { return itemHandler.customFilterF(aItem, aProperty, aStringMatcher, aNumericMatcher); }
+				[&](int aProperty) { return Values::getNumber(itemHandler, aItem, aProperty); },
+				[&](int aProperty, string& buffer_) -> const string& {
+					return Values::getString(itemHandler, aItem, aProperty, buffer_);
+				},
+				[&](int aProperty, const StringMatch& aStringMatcher, double aNumericMatcher) { return itemHandler.customFilterF(aItem, aProperty, aStringMatcher, aNumericMatcher); }
 			);
 		}
 
@@ -196,8 +217,8 @@ namespace webserver {
 				pattern = JsonUtil::parseValue<string>("pattern", patternJson);
 			}
 
-			aFilter.prepare(pattern, method, findPropertyByName(property, itemHandler.properties));
-			onFilterUpdated();
+			auto narrowed = aFilter.prepare(pattern, method, findPropertyByName(property, itemHandler.properties));
+			onFilterUpdated(narrowed);
 		}
 
 		api_return handlePostFilter(ApiRequest& aRequest) {
@@ -242,26 +263,106 @@ namespace webserver {
 			return websocketpp::http::status_code::no_content;
 		}
 
-		void onFilterUpdated() {
-			ItemList itemsNew;
+		// Set aNarrowed if the updated filters can't match items that aren't matching currently
+		// (only the current matching items need to be checked in that case)
+		void onFilterUpdated(bool aNarrowed = false) {
+			ItemList matchingList;
 			auto matchers = getFilterMatcherList();
+			auto filterKey = PropertyFilter::Matcher<PropertyFilter::Ptr>::getStateKey(matchers);
+
+			uint64_t resultVersion;
 			{
 				RLock l(cs);
-				for (const auto& i : sourceItems) {
-					if (matchesFilter(i, matchers)) {
-						itemsNew.push_back(i);
+				resultVersion = filterResultVersion;
+				if (!getCachedFilterResultUnsafe(filterKey, matchingList)) {
+					if (aNarrowed) {
+						auto items = matchingItems.toList();
+						items.insert(items.end(), unsortedMatchingItems.begin(), unsortedMatchingItems.end());
+						matchingList = filterItems(items, matchers);
+					} else if (isParallelItemCount(sourceItems.size())) {
+						matchingList = filterItems(ItemList(sourceItems.begin(), sourceItems.end()), matchers);
+					} else {
+						for (const auto& i : sourceItems) {
+							if (matchesFilter(i, matchers)) {
+								matchingList.push_back(i);
+							}
+						}
 					}
 				}
 			}
 
+			// The new list is built before locking and swapped in at once
+			decltype(matchingItems) itemsNew;
+			itemsNew.assign(matchingList);
+
 			{
 				WLock l(cs);
+				if (resultVersion == filterResultVersion) {
+					addCachedFilterResultUnsafe(filterKey, std::move(matchingList));
+				}
+
 				matchingItems.swap(itemsNew);
+				unsortedMatchingItems.clear();
 				itemListChanged = true;
 				currentValues.set(IntCollector::TYPE_RANGE_START, 0);
 			}
 		}
 
+		ItemList filterItems(const ItemList& aItems, const PropertyFilter::MatcherList& aMatchers) {
+			if (isParallelItemCount(aItems.size())) {
+				return ParallelUtil::filter(aItems, [&](const T& aItem) {
+					return matchesFilter(aItem, aMatchers);
+				});
+			}
+
+			ItemList ret;
+			for (const auto& i : aItems) {
+				if (matchesFilter(i, aMatchers)) {
+					ret.push_back(i);
+				}
+			}
+
+			return ret;
+		}
+
+		// Results of recent filter combinations are kept so that
+		// they don't need to be re-evaluated e.g. when removing characters from the pattern
+		bool getCachedFilterResultUnsafe(const string& aFilterKey, ItemList& items_) const {
+			auto i = find_if(filterResults.begin(), filterResults.end(), [&](const FilterResult& aResult) {
+				return aResult.filterKey == aFilterKey;
+			});
+
+			if (i == filterResults.end()) {
+				return false;
+			}
+
+			items_ = i->items;
+			return true;
+		}
+
+		void addCachedFilterResultUnsafe(const string& aFilterKey, ItemList&& aItems) {
+			if (aFilterKey.empty()) {
+				// No filters, all items match
+				return;
+			}
+
+			filterResults.erase(remove_if(filterResults.begin(), filterResults.end(), [&](const FilterResult& aResult) {
+				return aResult.filterKey == aFilterKey;
+			}), filterResults.end());
+
+			filterResults.push_front({ aFilterKey, std::move(aItems) });
+			if (filterResults.size() > MAX_FILTER_RESULTS) {
+				filterResults.pop_back();
+			}
+		}
+
+		// The cached results must be dropped whenever the items change
+		// Call in the same lock with the change so that filtering can't use (or cache) results that don't include it
+		void invalidateFilterResultsUnsafe() {
+			filterResults.clear();
+			filterResultVersion++;
+		}
+
 		// FILTERS END
 
 
@@ -322,6 +423,15 @@ namespace webserver {
 				}
 			}
 
+			{
+				// Keep only the items in viewport + margin sorted (null disables the windowed mode)
+				auto iter = j.find("window_margin");
+				if (iter != j.end()) {
+					updatedValues[IntCollector::TYPE_WINDOW_MARGIN] = iter.value().is_null() ? -1 :
+						JsonUtil::getRangeField<int>("window_margin", j, 0);
+				}
+			}
+
 			{
 				auto paused = JsonUtil::getOptionalField<bool>("paused", j);
 				if (paused) {
@@ -356,26 +466,23 @@ namespace webserver {
 			stop();
 		}
 
-		void sendJson(const json& j) {
-			if (j.is_null()) {
-				return;
-			}
-
-			module->send(viewName + "_updated", j);
+		void sendJson(const JsonWriter& aWriter) {
+			module->sendSerialized(viewName + "_updated", aWriter);
 		}
 
 		int initItems() {
 			WLock l(cs);
-			matchingItems = itemListF();
+			auto items = itemListF();
 
 			if (sourceFilter) {
 				auto matcher = PropertyFilter::Matcher<PropertyFilter*>(sourceFilter.get());
-				matchingItems.erase(remove_if(matchingItems.begin(), matchingItems.end(), [&](const T& aItem) {
+				items.erase(remove_if(items.begin(), items.end(), [&](const T& aItem) {
 					return !matchesFilter<PropertyFilter*>(aItem, matcher);
-				}), matchingItems.end());
+				}), items.end());
 			}
 
-			sourceItems.insert(matchingItems.begin(), matchingItems.end());
+			matchingItems.assign(items);
+			sourceItems.insert(items.begin(), items.end());
 
 			itemListChanged = true;
 			return static_cast<int>(matchingItems.size());
@@ -385,79 +492,98 @@ namespace webserver {
 			WLock l(cs);
 			tasks.clear();
 			currentViewportItems.clear();
+			currentViewportItemSet.clear();
 			matchingItems.clear();
+			unsortedMatchingItems.clear();
+			sortWindowSize = 0;
+			getFragmentCache().remove(sourceItems);
 			sourceItems.clear();
 			prevTotalItemCount = -1;
 			prevMatchingItemCount = -1;
 			filters.clear();
+			sortKeys.clear();
+			invalidateFilterResultsUnsafe();
 		}
 
-		static bool itemSort(const T& t1, const T& t2, const PropertyItemHandler<T>& aItemHandler, int aSortProperty, int aSortAscending) {
-			int res = 0;
-			switch (aItemHandler.properties[aSortProperty].sortMethod) {
-			case SORT_NUMERIC: {
-				res = compare(aItemHandler.numberF(t1, aSortProperty), aItemHandler.numberF(t2, aSortProperty));
-				break;
-			}
-			case SORT_TEXT: {
-				res = Util::DefaultSort(aItemHandler.stringF(t1, aSortProperty).c_str(), aItemHandler.stringF(t2, aSortProperty).c_str());
-				break;
-			}
-			case SORT_CUSTOM: {
-				res = aItemHandler.customSorterF(t1, t2, aSortProperty);
-				break;
-			}
-			case SORT_NONE: break;
-			default: dcassert(0);
-			}
-
+		// Compares the cached sort keys of the current sort property
+		// Must be called while holding the write lock
+		bool itemSort(const T& t1, const T& t2, int aSortAscending) {
+			auto res = sortKeys.compareItems(t1, t2);
 			return aSortAscending == 1 ? res < 0 : res > 0;
 		}
 
+		auto getItemSorter(int aSortProperty, int aSortAscending) {
+			dcassert(sortKeys.getProperty() == aSortProperty);
+			return [this, aSortAscending](const T& t1, const T& t2) {
+				return itemSort(t1, t2, aSortAscending);
+			};
+		}
+
+		// Drop cached sort keys of items with updated sort property values
+		void updateSortKeys(const typename ItemTasks<T>::TaskMap& aTaskList, int aSortProperty, int aSortAscending) {
+			WLock l(cs);
+			sortKeys.setProperty(aSortProperty);
+			currentSortAscending = aSortAscending;
+
+			for (const auto& t : aTaskList) {
+				if (t.second.type == UPDATE_ITEM) {
+					sortKeys.onItemUpdated(t.first, t.second.updatedProperties);
+				} else if (t.second.type == ADD_ITEM) {
+					sortKeys.onItemRemoved(t.first);
+				}
+			}
+		}
+
 		api_return handleGetItems(ApiRequest& aRequest) {
 			auto start = aRequest.getRangeParam(START_POS);
-			auto end = aRequest.getRangeParam(MAX_COUNT);
-			decltype(matchingItems) matchingItemsCopy;
+			auto count = aRequest.getRangeParam(MAX_COUNT) - start;
+
+			// Copy only the requested range
+			ItemList items;
+			int listSize = 0;
 
 			{
-				RLock l(cs);
-				matchingItemsCopy = matchingItems;
+				WLock l(cs);
+				listSize = static_cast<int>(getMatchingItemCountUnsafe());
+				if (start < listSize && count > 0) {
+					if (start + count > static_cast<int>(matchingItems.size())) {
+						// Scrolled past the sorted window
+						materializeItemsUnsafe();
+					}
+
+					matchingItems.copyRange(start, count, back_inserter(items));
+				}
 			}
 
-			auto j = Serializer::serializeFromPosition(start, end - start, matchingItemsCopy, [&](const T& i) {
-				return Serializer::serializeItem(i, itemHandler);
-			});
+			if (listSize > 0 && (start >= listSize || count <= 0)) {
+				throw std::domain_error("Invalid range");
+			}
 
-			aRequest.setResponseBody(j);
+			JsonWriter writer;
+			Serializer::serializeItemList(writer, itemHandler, items);
+			aRequest.setSerializedResponseBody(std::move(writer));
 			return websocketpp::http::status_code::ok;
 		}
 
-		typename ItemList::iterator findItem(const T& aItem, ItemList& aItems) noexcept {
-			return find(aItems.begin(), aItems.end(), aItem);
-		}
-
-		typename ItemList::const_iterator findItem(const T& aItem, const ItemList& aItems) const noexcept {
-			return find(aItems.begin(), aItems.end(), aItem);
-		}
-
-		bool isInList(const T& aItem, const ItemList& aItems) const noexcept {
-			return findItem(aItem, aItems) != aItems.end();
-		}
-
-		int64_t getPosition(const T& aItem, const ItemList& aItems) const noexcept {
-			auto i = findItem(aItem, aItems);
-			if (i == aItems.end()) {
-				return -1;
+		// TASKS START
+		void reportTaskStats(size_t aEventCount, size_t aTaskCount) noexcept {
+#ifdef _DEBUG
+			if (aEventCount == 0) {
+				return;
 			}
 
-			return distance(aItems.begin(), i);
+			auto stats = tasks.takeStats();
+			dcdebug("Table %s: %d events coalesced into %d tasks (average push time " U64_FMT " ns, max push time " U64_FMT " ns, max queue time " U64_FMT " ms)\n",
+				viewName.c_str(), static_cast<int>(aEventCount), static_cast<int>(aTaskCount),
+				stats.events > 0 ? stats.totalPushTimeNs / stats.events : 0, stats.maxPushTimeNs, stats.maxQueueTimeMs);
+#endif
 		}
 
-		// TASKS START
 		void runTasks() {
 			typename ItemTasks<T>::TaskMap currentTasks;
 			PropertyIdSet updatedProperties;
-			tasks.get(currentTasks, updatedProperties);
+			auto eventCount = tasks.get(currentTasks, updatedProperties);
+			reportTaskStats(eventCount, currentTasks.size());
 
 			// Anything to update?
 			if (currentTasks.empty() && !currentValues.hasChanged() && !itemListChanged) {
@@ -479,28 +605,40 @@ namespace webserver {
 				return;
 			}
 
-			maybeSort(updatedProperties, sortProperty, sortAscending);
+			updateSortKeys(currentTasks, sortProperty, sortAscending);
+			auto windowMargin = updateValues[IntCollector::TYPE_WINDOW_MARGIN];
+			auto windowSize = getSortWindowSize(updateValues[IntCollector::TYPE_RANGE_START], updateValues[IntCollector::TYPE_MAX_COUNT], windowMargin);
+			auto windowModeChanged = (prevValues[IntCollector::TYPE_WINDOW_MARGIN] < 0) != (windowMargin < 0);
+			maybeSort(currentTasks, updatedProperties, sortProperty, sortAscending, windowSize, windowModeChanged);
 
 			// Start position
 			auto newStart = updateValues[IntCollector::TYPE_RANGE_START];
 
-			json j;
+			JsonWriter writer;
+			writer.startObject();
 
 			// Go through the tasks
 			auto updatedItems = handleTasks(currentTasks, sortProperty, sortAscending, newStart);
 
+			updateSortWindow(newStart, updateValues[IntCollector::TYPE_MAX_COUNT], sortProperty, sortAscending);
+
 			ItemList nextViewportItems;
+			bool itemsSerialized = true;
 			if (newStart >= 0) {
 				// Get the new visible items
-				updateViewItems(updatedItems, j, newStart, updateValues[IntCollector::TYPE_MAX_COUNT], nextViewportItems);
+				typename PropertyFragmentCache<T>::PendingList newFragments;
+				itemsSerialized = updateViewItems(updatedItems, writer, newStart, updateValues[IntCollector::TYPE_MAX_COUNT], nextViewportItems, newFragments);
+				storeFragments(std::move(newFragments));
 
 				// Append other changed properties
 				auto startOffset = newStart - updateValues[IntCollector::TYPE_RANGE_START];
 				if (startOffset != 0) {
-					j["range_offset"] = startOffset;
+					writer.writeKey("range_offset");
+					writer.writeInteger(startOffset);
 				}
 
-				j["range_start"] = newStart;
+				writer.writeKey("range_start");
+				writer.writeInteger(newStart);
 			}
 
 			{
@@ -514,17 +652,21 @@ namespace webserver {
 				// Set cached values
 				prevValues.swap(updateValues);
 				currentViewportItems.swap(nextViewportItems);
+				currentViewportItemSet.assign(currentViewportItems);
 
 				dcassert((matchingItems.size() != 0 && sourceItems.size() != 0) || currentViewportItems.empty());
 			}
 
 			// Counts should be updated even if the list doesn't have valid settings posted
-			appendItemCounts(j);
+			auto countsChanged = appendItemCounts(writer);
 
-			sendJson(j);
+			writer.endObject();
+			if (itemsSerialized && (newStart >= 0 || countsChanged)) {
+				sendJson(writer);
+			}
 		}
 
-		typedef std::map<T, const PropertyIdSet&> ItemPropertyIdMap;
+		typedef std::unordered_map<T, PropertyIdSet, ItemPointerHash<T>> ItemPropertyIdMap;
 		ItemPropertyIdMap handleTasks(const typename ItemTasks<T>::TaskMap& aTaskList, int aSortProperty, int aSortAscending, int& rangeStart_) {
 			ItemPropertyIdMap updatedItems;
 			for (auto& t : aTaskList) {
@@ -549,9 +691,10 @@ namespace webserver {
 			return updatedItems;
 		}
 
-		void updateViewItems(const ItemPropertyIdMap& aUpdatedItems, json& json_, int& newStart_, int aMaxCount, ItemList& nextViewportItems_) {
+		// Returns false if the item properties couldn't be serialized
+		bool updateViewItems(const ItemPropertyIdMap& aUpdatedItems, JsonWriter& writer_, int& newStart_, int aMaxCount, ItemList& nextViewportItems_,
+			typename PropertyFragmentCache<T>::PendingList& newFragments_) {
 			// Get the new visible items
-			ItemList currentItemsCopy;
 			{
 				RLock l(cs);
 				if (newStart_ >= static_cast<int>(sourceItems.size())) {
@@ -560,84 +703,271 @@ namespace webserver {
 
 				auto count = min(static_cast<int>(matchingItems.size()) - newStart_, aMaxCount);
 				if (count < 0) {
-					return;
+					return true;
 				}
 
 
-				auto startIter = matchingItems.begin();
-				std::advance(startIter, newStart_);
-
-				auto endIter = startIter;
-				std::advance(endIter, count);
+				matchingItems.copyRange(newStart_, count, back_inserter(nextViewportItems_));
 
-				std::copy(startIter, endIter, back_inserter(nextViewportItems_));
-				currentItemsCopy = currentViewportItems;
+				// Check which items are new in the viewport (the set is modified only while holding the write lock)
+				newViewportItems.assign(nextViewportItems_.size(), false);
+				for (size_t i = 0; i < nextViewportItems_.size(); ++i) {
+					newViewportItems[i] = !currentViewportItemSet.contains(nextViewportItems_[i]);
+				}
 			}
 
-			json_["items"] = json::array();
-
 			// List items
-			int pos = 0;
-			for (const auto& item : nextViewportItems_) {
-				if (!isInList(item, currentItemsCopy)) {
-					appendItemFull(item, json_, pos);
-				} else {
-					// append position
-					auto props = aUpdatedItems.find(item);
-					if (props != aUpdatedItems.end()) {
-						appendItemPartial(item, json_, pos, props->second);
+			const auto allProperties = toPropertyIdSet(itemHandler.properties);
+
+			try {
+				writer_.writeKey("items");
+				writer_.startArray();
+				for (size_t i = 0; i < nextViewportItems_.size(); ++i) {
+					const auto& item = nextViewportItems_[i];
+					if (newViewportItems[i]) {
+						appendItemPartial(item, writer_, allProperties, newFragments_);
 					} else {
-						appendItemPosition(item, json_, pos);
+						// append position
+						auto props = aUpdatedItems.find(item);
+						if (props != aUpdatedItems.end()) {
+							appendItemPartial(item, writer_, props->second, newFragments_);
+						} else {
+							appendItemPosition(item, writer_);
+						}
 					}
 				}
 
-				pos++;
+				writer_.endArray();
+			} catch (const std::exception& e) {
+				// Invalid UTF-8 in property values
+				dcdebug("Failed to serialize view items: %s\n", e.what());
+				return false;
 			}
+
+			return true;
 		}
 
-		void maybeSort(const PropertyIdSet& aUpdatedProperties, int aSortProperty, int aSortAscending) {
-			bool needSort = aUpdatedProperties.find(aSortProperty) != aUpdatedProperties.end() ||
-				prevValues[IntCollector::TYPE_SORT_ASCENDING] != aSortAscending ||
+		void maybeSort(const typename ItemTasks<T>::TaskMap& aTaskList, const PropertyIdSet& aUpdatedProperties, int aSortProperty, int aSortAscending, size_t aWindowSize, bool aWindowModeChanged) {
+			bool needFullSort = prevValues[IntCollector::TYPE_SORT_ASCENDING] != aSortAscending ||
 				prevValues[IntCollector::TYPE_SORT_PROPERTY] != aSortProperty ||
+				aWindowModeChanged ||
 				itemListChanged;
 
+			bool sortPropertyUpdated = aUpdatedProperties.contains(aSortProperty);
+
 			itemListChanged = false;
 
-			if (needSort) {
-				auto start = GET_TICK();
+			if (!needFullSort && !sortPropertyUpdated) {
+				return;
+			}
+
+			auto start = GET_TICK();
 
-				WLock l(cs);
-				std::stable_sort(matchingItems.begin(), matchingItems.end(),
-					std::bind(&ListViewController::itemSort,
-						std::placeholders::_1,
-						std::placeholders::_2,
-						itemHandler,
-						aSortProperty,
-						aSortAscending
-						));
+			WLock l(cs);
+			if (!needFullSort) {
+				// Reposition the changed items unless most of the list has changed
+				auto changedItems = getSortPropertyChangedItemsUnsafe(aTaskList, aSortProperty);
+				if (changedItems.size() * 2 <= getMatchingItemCountUnsafe()) {
+					repositionMatchingItemsUnsafe(changedItems, aSortProperty, aSortAscending);
+
+					incrementalSortCount++;
+					repositionedItemCount += changedItems.size();
+					dcdebug("Table %s: %d items repositioned in " U64_FMT " ms (full sorts: " U64_FMT ", incremental sorts: " U64_FMT ", repositioned items: " U64_FMT ")\n",
+						viewName.c_str(), static_cast<int>(changedItems.size()), GET_TICK() - start, fullSortCount, incrementalSortCount, repositionedItemCount);
+					return;
+				}
+			}
+
+			sortMatchingItemsUnsafe(aSortProperty, aSortAscending, aWindowSize);
+
+			fullSortCount++;
+			dcdebug("Table %s sorted in " U64_FMT " ms (full sorts: " U64_FMT ", incremental sorts: " U64_FMT ", repositioned items: " U64_FMT ")\n",
+				viewName.c_str(), GET_TICK() - start, fullSortCount, incrementalSortCount, repositionedItemCount);
+		}
+
+		// Matching items with an updated sort property value
+		ItemList getSortPropertyChangedItemsUnsafe(const typename ItemTasks<T>::TaskMap& aTaskList, int aSortProperty) const noexcept {
+			ItemList ret;
+			for (const auto& t : aTaskList) {
+				if (t.second.type != UPDATE_ITEM || !t.second.updatedProperties.contains(aSortProperty)) {
+					continue;
+				}
+
+				if (isMatchingItemUnsafe(t.first)) {
+					ret.push_back(t.first);
+				}
+			}
+
+			return ret;
+		}
+
+		void repositionMatchingItemsUnsafe(const ItemList& aItems, int aSortProperty, int aSortAscending) {
+			// All items must be removed first so that the remaining list stays ordered while inserting
+			for (const auto& item : aItems) {
+				if (matchingItems.erase(item) == -1) {
+					unsortedMatchingItems.erase(item);
+				}
+			}
+
+			for (const auto& item : aItems) {
+				insertMatchingItemUnsafe(item, aSortProperty, aSortAscending);
+			}
+		}
+
+		// WINDOWED MODE START
+
+		// Windowed mode keeps only the items in the current viewport (and the following margin items) sorted,
+		// which avoids sorting the full list for views with a large number of items.
+		// Rest of the matching items are stored in an unordered pool.
+
+		// Returns 0 if all items should be sorted
+		static size_t getSortWindowSize(int aRangeStart, int aMaxCount, int aMargin) noexcept {
+			if (aMargin < 0 || aRangeStart < 0 || aMaxCount <= 0) {
+				return 0;
+			}
+
+			return static_cast<size_t>(aRangeStart) + aMaxCount + aMargin;
+		}
+
+		size_t getMatchingItemCountUnsafe() const noexcept {
+			return matchingItems.size() + unsortedMatchingItems.size();
+		}
+
+		bool isMatchingItemUnsafe(const T& aItem) const noexcept {
+			return matchingItems.contains(aItem) || unsortedMatchingItems.find(aItem) != unsortedMatchingItems.end();
+		}
+
+		// Sort all matching items or select the first aWindowSize items with a bounded heap (0 = sort all items)
+		void sortMatchingItemsUnsafe(int aSortProperty, int aSortAscending, size_t aWindowSize) {
+			auto sorter = getItemSorter(aSortProperty, aSortAscending);
+			sortWindowSize = aWindowSize;
+
+			auto items = matchingItems.toList();
+			items.insert(items.end(), unsortedMatchingItems.begin(), unsortedMatchingItems.end());
+			unsortedMatchingItems.clear();
 
-				dcdebug("Table %s sorted in " U64_FMT " ms\n", viewName.c_str(), GET_TICK() - start);
+			if (aWindowSize == 0 || items.size() <= aWindowSize) {
+				sortItemsUnsafe(items, sorter);
+				matchingItems.assign(items);
+				return;
 			}
+
+			// The last item of the window is kept on top of the heap
+			ItemList window;
+			window.reserve(aWindowSize);
+			for (const auto& item : items) {
+				if (window.size() < aWindowSize) {
+					window.push_back(item);
+					std::push_heap(window.begin(), window.end(), sorter);
+				} else if (sorter(item, window.front())) {
+					std::pop_heap(window.begin(), window.end(), sorter);
+					unsortedMatchingItems.insert(window.back());
+					window.back() = item;
+					std::push_heap(window.begin(), window.end(), sorter);
+				} else {
+					unsortedMatchingItems.insert(item);
+				}
+			}
+
+			std::sort_heap(window.begin(), window.end(), sorter);
+			matchingItems.assign(window);
 		}
 
-		void appendItemCounts(json& json_) {
+		// Large lists are sorted in multiple threads
+		template<class SorterT>
+		void sortItemsUnsafe(ItemList& items_, const SorterT& aSorter) {
+			if (isParallelItemCount(items_.size()) && sortKeys.prepare(items_)) {
+				ParallelUtil::stableSort(items_.begin(), items_.end(), aSorter);
+			} else {
+				std::stable_sort(items_.begin(), items_.end(), aSorter);
+			}
+		}
+
+		static bool isParallelItemCount(size_t aItemCount) noexcept {
+			auto threshold = WEBCFG(VIEW_PARALLEL_THRESHOLD).num();
+			return threshold > 0 && aItemCount >= static_cast<size_t>(threshold);
+		}
+
+		// Sort all items (e.g. when the client has scrolled past the sorted window)
+		// The window will be applied again after the next full sort
+		void materializeItemsUnsafe() {
+			if (unsortedMatchingItems.empty()) {
+				return;
+			}
+
+			dcdebug("Table %s: materializing %d unsorted items\n", viewName.c_str(), static_cast<int>(unsortedMatchingItems.size()));
+			sortMatchingItemsUnsafe(sortKeys.getProperty(), currentSortAscending, 0);
+		}
+
+		// Ensure that the sorted window covers the current viewport
+		void updateSortWindow(int aRangeStart, int aMaxCount, int aSortProperty, int aSortAscending) {
+			WLock l(cs);
+			if (unsortedMatchingItems.empty() || aRangeStart < 0 || aMaxCount <= 0) {
+				return;
+			}
+
+			auto viewportEnd = static_cast<size_t>(aRangeStart) + aMaxCount;
+			if (viewportEnd > sortWindowSize) {
+				// Scrolled past the window
+				materializeItemsUnsafe();
+			} else if (viewportEnd > matchingItems.size()) {
+				// Too many items were removed from the window, fill it again
+				sortMatchingItemsUnsafe(aSortProperty, aSortAscending, sortWindowSize);
+			}
+		}
+
+		// Insert an item in the sorted list or in the unsorted pool (windowed mode)
+		// Returns the position in the sorted list or -1 if the item wasn't added there
+		int64_t insertMatchingItemUnsafe(const T& aItem, int aSortProperty, int aSortAscending) {
+			auto sorter = getItemSorter(aSortProperty, aSortAscending);
+			if (sortWindowSize > 0 && (matchingItems.size() >= sortWindowSize || !unsortedMatchingItems.empty())) {
+				// Unsorted items may precede items that are ordered after the window
+				if (matchingItems.empty() || !sorter(aItem, matchingItems.at(matchingItems.size() - 1))) {
+					unsortedMatchingItems.insert(aItem);
+					return -1;
+				}
+
+				auto pos = matchingItems.insert(aItem, sorter);
+				if (matchingItems.size() > sortWindowSize) {
+					auto last = matchingItems.at(matchingItems.size() - 1);
+					matchingItems.erase(last);
+					unsortedMatchingItems.insert(last);
+				}
+
+				return pos;
+			}
+
+			return matchingItems.insert(aItem, sorter);
+		}
+
+		// WINDOWED MODE END
+
+		// Returns true if the counts have changed
+		bool appendItemCounts(JsonWriter& writer_) {
 			int matchingItemCount = 0, totalItemCount = 0;
 
 			{
 				RLock l(cs);
-				matchingItemCount = matchingItems.size();
+				matchingItemCount = static_cast<int>(getMatchingItemCountUnsafe());
 				totalItemCount = sourceItems.size();
 			}
 
+			bool changed = false;
 			if (matchingItemCount != prevMatchingItemCount) {
 				prevMatchingItemCount = matchingItemCount;
-				json_["matching_items"] = matchingItemCount;
+				writer_.writeKey("matching_items");
+				writer_.writeInteger(matchingItemCount);
+				changed = true;
 			}
 
 			if (totalItemCount != prevTotalItemCount) {
 				prevTotalItemCount = totalItemCount;
-				json_["total_items"] = totalItemCount;
+				writer_.writeKey("total_items");
+				writer_.writeInteger(totalItemCount);
+				changed = true;
 			}
+
+			return changed;
 		}
 
 		void handleAddItemTask(const T& aItem, int aSortProperty, int aSortAscending, int& rangeStart_) {
@@ -649,6 +979,7 @@ namespace webserver {
 
 			WLock l(cs);
 			sourceItems.emplace(aItem);
+			invalidateFilterResultsUnsafe();
 			if (matchesFilters) {
 				addMatchingItemUnsafe(aItem, aSortProperty, aSortAscending, rangeStart_);
 			}
@@ -656,7 +987,10 @@ namespace webserver {
 
 		void handleRemoveItemTask(const T& aItem, int& rangeStart_) {
 			WLock l(cs);
+			getFragmentCache().remove(aItem);
 			sourceItems.erase(aItem);
+			invalidateFilterResultsUnsafe();
+			sortKeys.onItemRemoved(aItem);
 			removeMatchingItemUnsafe(aItem, rangeStart_);
 		}
 
@@ -680,7 +1014,7 @@ namespace webserver {
 
 			{
 				RLock l(cs);
-				inList = isInList(aItem, matchingItems);
+				inList = isMatchingItemUnsafe(aItem);
 
 				// A delayed update for a removed item?
 				if (!inList && sourceItems.find(aItem) == sourceItems.end()) {
@@ -688,16 +1022,19 @@ namespace webserver {
 				}
 			}
 
-			auto matchers = getFilterMatcherList();
-			if (!matchesFilter(aItem, matchers)) {
+			auto matches = matchesFilter(aItem, getFilterMatcherList());
+
+			WLock l(cs);
+
+			// The cached results may depend on the updated property values
+			invalidateFilterResultsUnsafe();
+			if (!matches) {
 				if (inList) {
-					WLock l(cs);
 					removeMatchingItemUnsafe(aItem, rangeStart_);
 				}
 
 				return false;
 			} else if (!inList) {
-				WLock l(cs);
 				addMatchingItemUnsafe(aItem, aSortProperty, aSortAscending, rangeStart_);
 				return false;
 			}
@@ -708,17 +1045,16 @@ namespace webserver {
 
 		// Add an item in the current matching view item list
 		void addMatchingItemUnsafe(const T& aItem, int aSortProperty, int aSortAscending, int& rangeStart_) {
-			auto matchingItemsIter = matchingItems.insert(
-				std::upper_bound(
-					matchingItems.begin(),
-					matchingItems.end(),
-					aItem,
-					std::bind(&ListViewController::itemSort, std::placeholders::_1, std::placeholders::_2, itemHandler, aSortProperty, aSortAscending)
-				),
-				aItem
-			);
+			if (isMatchingItemUnsafe(aItem)) {
+				return;
+			}
+
+			auto pos = insertMatchingItemUnsafe(aItem, aSortProperty, aSortAscending);
+			if (pos == -1) {
+				// Not in the sorted window
+				return;
+			}
 
-			auto pos = static_cast<int>(std::distance(matchingItems.begin(), matchingItemsIter));
 			if (pos < rangeStart_) {
 				// Update the range range positions
 				rangeStart_++;
@@ -727,15 +1063,16 @@ namespace webserver {
 
 		// Remove an item from the current matching view item list
 		void removeMatchingItemUnsafe(const T& aItem, int& rangeStart_) {
-			auto matchingItemsIter = findItem(aItem, matchingItems);
-			if (matchingItemsIter == matchingItems.end()) {
-				//dcassert(0);
-				return;
-			}
-
-			auto pos = static_cast<int>(std::distance(matchingItems.begin(), matchingItemsIter));
+			auto pos = matchingItems.erase(aItem);
+			if (pos == -1) {
+				if (unsortedMatchingItems.erase(aItem) == 0) {
+					//dcassert(0);
+					return;
+				}
 
-			matchingItems.erase(matchingItemsIter);
+				// Positioned after the sorted window
+				pos = static_cast<int64_t>(matchingItems.size());
+			}
 
 			if (rangeStart_ > 0 && pos > rangeStart_) {
 				// Update the range range positions
@@ -747,25 +1084,76 @@ namespace webserver {
 
 		// JSON APPEND START
 
-		// Append item with all property values
-		void appendItemFull(const T& aItem, json& json_, int pos) {
-			appendItemPartial(aItem, json_, pos, toPropertyIdSet(itemHandler.properties));
+		// Append item with supplied property values
+		// Property values are taken from the shared fragment cache when possible and the new values are added in newFragments_
+		void appendItemPartial(const T& aItem, JsonWriter& writer_, const PropertyIdSet& aPropertyIds, typename PropertyFragmentCache<T>::PendingList& newFragments_) {
+			writer_.startObject();
+			writer_.writeKey("id");
+			writer_.writeJson(aItem->getToken());
+			writer_.writeKey("properties");
+			writer_.startObject();
+
+			uint32_t cacheVersion;
+			auto missingIds = getFragmentCache().write(aItem, aPropertyIds, itemHandler.formattedKeys, writer_, cacheVersion);
+			if (!missingIds.empty()) {
+				typename PropertyFragmentCache<T>::FragmentList fragments;
+				for (auto id : missingIds) {
+					writer_.writeFormattedKey(itemHandler.formattedKeys[id]);
+
+					auto valueStart = writer_.size();
+					Serializer::serializePropertyValue(writer_, aItem, itemHandler, id);
+					fragments.emplace_back(id, writer_.str().substr(valueStart));
+				}
+
+				newFragments_.emplace_back(aItem, cacheVersion, std::move(fragments));
+			}
+
+			writer_.endObject();
+			writer_.endObject();
 		}
 
-		// Append item with supplied property values
-		void appendItemPartial(const T& aItem, json& json_, int pos, const PropertyIdSet& aPropertyIds) {
-			appendItemPosition(aItem, json_, pos);
-			json_["items"][pos]["properties"] = Serializer::serializeProperties(aItem, itemHandler, aPropertyIds);
+		// Share the serialized values with other views
+		// Values of items that have been removed from the list meanwhile can't be stored as the removal may have invalidated them already
+		void storeFragments(typename PropertyFragmentCache<T>::PendingList&& aFragments) {
+			if (aFragments.empty()) {
+				return;
+			}
+
+			RLock l(cs);
+			aFragments.erase(std::remove_if(aFragments.begin(), aFragments.end(), [this](const typename PropertyFragmentCache<T>::PendingItem& aPending) {
+				return sourceItems.find(aPending.item) == sourceItems.end();
+			}), aFragments.end());
+
+			getFragmentCache().store(std::move(aFragments));
+		}
+
+		// Serialized property values shared by all views of this item type
+		static PropertyFragmentCache<T>& getFragmentCache() noexcept {
+			static PropertyFragmentCache<T> cache;
+			return cache;
 		}
 
 		// Append item without property values
-		void appendItemPosition(const T& aItem, json& json_, int pos) {
-			json_["items"][pos]["id"] = aItem->getToken();
+		void appendItemPosition(const T& aItem, JsonWriter& writer_) {
+			writer_.startObject();
+			writer_.writeKey("id");
+			writer_.writeJson(aItem->getToken());
+			writer_.endObject();
 		}
 
 		// List of dynamically set filters
 		PropertyFilter::List filters;
 
+		struct FilterResult {
+			string filterKey;
+			ItemList items;
+		};
+
+		// Most recent first
+		std::deque<FilterResult> filterResults;
+		uint64_t filterResultVersion = 0;
+		static const size_t MAX_FILTER_RESULTS = 5;
+
 		// This one should be provided when initiating the view
 		// Items that don't match the filter won't be added in source items or included in total item count
 		unique_ptr<PropertyFilter> sourceFilter;
@@ -775,11 +1163,26 @@ namespace webserver {
 
 		const PropertyItemHandler<T>& itemHandler;
 
+		// Values of the current sort property
+		SortKeyCache<T, Values> sortKeys;
+
 		// Items visible in the current viewport
 		ItemList currentViewportItems;
+		ItemPointerSet<T> currentViewportItemSet;
+
+		// Whether each item in the next viewport wasn't visible previously (reused between the updates)
+		vector<bool> newViewportItems;
 
-		// All items matching the list of dynamic filters
-		ItemList matchingItems;
+		// All items matching the list of dynamic filters (in the current sort order)
+		// Contains only the items within the sort window when using the windowed mode
+		RankedItemList<T> matchingItems;
+
+		// Matching items outside of the sort window (windowed mode only)
+		std::unordered_set<T, ItemPointerHash<T>> unsortedMatchingItems;
+
+		// Maximum number of items in the sorted list (0 = all matching items are sorted)
+		size_t sortWindowSize = 0;
+		int currentSortAscending = -1;
 
 		bool active = false;
 
@@ -799,6 +1202,7 @@ namespace webserver {
 				TYPE_SORT_ASCENDING,
 				TYPE_RANGE_START,
 				TYPE_MAX_COUNT,
+				TYPE_WINDOW_MARGIN,
 				TYPE_LAST
 			};
 
@@ -844,6 +1248,11 @@ namespace webserver {
 
 		int prevMatchingItemCount = -1;
 		int prevTotalItemCount = -1;
+
+		// Sorting statistics (for debugging purposes)
+		uint64_t fullSortCount = 0;
+		uint64_t incrementalSortCount = 0;
+		uint64_t repositionedItemCount = 0;
 		ItemListF itemListF;
 		typename IntCollector::ValueMap prevValues;
 	};
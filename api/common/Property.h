@@ -19,7 +19,16 @@
 #ifndef DCPP_PROPERTY_H
 #define DCPP_PROPERTY_H
 
+#include <web-server/JsonWriter.h>
+
 #include <airdcpp/StringMatch.h>
+#include <airdcpp/Util.h>
+
+#include <array>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace webserver {
 
@@ -62,7 +71,154 @@ namespace webserver {
 
 	typedef vector<Property> PropertyList;
 
-	typedef std::set<int> PropertyIdSet;
+	// Fixed-size set of property IDs stored as a bitmask
+	// Merging, iteration and copying don't allocate memory
+	template<size_t MaxCount>
+	class PropertyMask {
+		static const size_t WORD_BITS = 64;
+		static const size_t WORD_COUNT = (MaxCount + WORD_BITS - 1) / WORD_BITS;
+	public:
+		static const size_t MAX_COUNT = MaxCount;
+
+		// Iterates the IDs in ascending order
+		class const_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef int value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const int* pointer;
+			typedef int reference;
+
+			const_iterator(const PropertyMask* aMask, size_t aPos) noexcept : mask(aMask), pos(aPos) {
+				seek();
+			}
+
+			int operator*() const noexcept { return static_cast<int>(pos); }
+
+			const_iterator& operator++() noexcept {
+				pos++;
+				seek();
+				return *this;
+			}
+
+			const_iterator operator++(int) noexcept {
+				auto ret = *this;
+				++(*this);
+				return ret;
+			}
+
+			bool operator==(const const_iterator& aOther) const noexcept { return pos == aOther.pos; }
+			bool operator!=(const const_iterator& aOther) const noexcept { return pos != aOther.pos; }
+		private:
+			// Move to the next set bit (or to the end)
+			void seek() noexcept {
+				while (pos < MaxCount) {
+					auto word = mask->words[pos / WORD_BITS] >> (pos % WORD_BITS);
+					if (word != 0) {
+						pos += countTrailingZeros(word);
+						return;
+					}
+
+					pos = (pos / WORD_BITS + 1) * WORD_BITS;
+				}
+
+				pos = MaxCount;
+			}
+
+			const PropertyMask* mask;
+			size_t pos;
+		};
+
+		PropertyMask() noexcept { }
+
+		PropertyMask(std::initializer_list<int> aIds) noexcept {
+			for (auto id : aIds) {
+				insert(id);
+			}
+		}
+
+		void insert(int aId) noexcept {
+			dcassert(aId >= 0 && static_cast<size_t>(aId) < MaxCount);
+			words[aId / WORD_BITS] |= uint64_t(1) << (aId % WORD_BITS);
+		}
+
+		void erase(int aId) noexcept {
+			dcassert(aId >= 0 && static_cast<size_t>(aId) < MaxCount);
+			words[aId / WORD_BITS] &= ~(uint64_t(1) << (aId % WORD_BITS));
+		}
+
+		bool contains(int aId) const noexcept {
+			if (aId < 0 || static_cast<size_t>(aId) >= MaxCount) {
+				return false;
+			}
+
+			return (words[aId / WORD_BITS] >> (aId % WORD_BITS)) & 1;
+		}
+
+		bool empty() const noexcept {
+			return std::all_of(words, words + WORD_COUNT, [](uint64_t aWord) { return aWord == 0; });
+		}
+
+		size_t size() const noexcept {
+			return std::distance(begin(), end());
+		}
+
+		void clear() noexcept {
+			std::fill(words, words + WORD_COUNT, 0);
+		}
+
+		void swap(PropertyMask& aOther) noexcept {
+			std::swap(words, aOther.words);
+		}
+
+		const_iterator begin() const noexcept {
+			return const_iterator(this, 0);
+		}
+
+		const_iterator end() const noexcept {
+			return const_iterator(this, MaxCount);
+		}
+
+		PropertyMask& operator|=(const PropertyMask& aOther) noexcept {
+			for (size_t i = 0; i < WORD_COUNT; ++i) {
+				words[i] |= aOther.words[i];
+			}
+
+			return *this;
+		}
+
+		PropertyMask operator|(const PropertyMask& aOther) const noexcept {
+			auto ret = *this;
+			ret |= aOther;
+			return ret;
+		}
+
+		bool operator==(const PropertyMask& aOther) const noexcept {
+			return std::equal(words, words + WORD_COUNT, aOther.words);
+		}
+
+		bool operator!=(const PropertyMask& aOther) const noexcept {
+			return !(*this == aOther);
+		}
+	private:
+		static size_t countTrailingZeros(uint64_t aWord) noexcept {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, aWord);
+			return index;
+#else
+			return __builtin_ctzll(aWord);
+#endif
+		}
+
+		uint64_t words[WORD_COUNT] = { };
+	};
+
+	// Maximum number of properties for each item type
+	// (list views verify that their property count fits in the set)
+	const size_t MAX_PROPERTY_COUNT = 64;
+
+	typedef PropertyMask<MAX_PROPERTY_COUNT> PropertyIdSet;
 
 	// Creates a list of numeric IDs of all properties
 	static inline PropertyIdSet toPropertyIdSet(const PropertyList& aProperties) {
@@ -82,6 +238,72 @@ namespace webserver {
 		return (*p).id;
 	}
 
+	// Helpers for returning text values from PropertyItemHandler::StringRefFunction implementations
+	// Values that are returned by reference are passed through and temporary values are moved to the scratch buffer
+	inline const string& toPropertyString(const string& aValue, string&) noexcept {
+		return aValue;
+	}
+
+	inline const string& toPropertyString(string&& aValue, string& buffer_) noexcept {
+		buffer_ = std::move(aValue);
+		return buffer_;
+	}
+
+	inline const string& toPropertyString(const string&& aValue, string& buffer_) noexcept {
+		buffer_ = aValue;
+		return buffer_;
+	}
+
+	// Accessors for the text and numeric values of a single property
+	// Accessors that don't apply to the property are left empty
+	template <class T>
+	struct PropertyAccessor {
+		typedef const string& (*StringF)(const T& aItem, string& buffer_);
+		typedef double (*NumberF)(const T& aItem);
+
+		int id;
+		StringF stringF;
+		NumberF numberF;
+	};
+
+	// Value accessors of all properties of an item type, indexed by the property ID
+	// The *Utils classes declare their tables in the headers so that the list views can call the accessors directly
+	template <class T, size_t PropertyCount>
+	using PropertyAccessorTable = std::array<PropertyAccessor<T>, PropertyCount>;
+
+	template <class T, size_t PropertyCount>
+	constexpr bool isValidAccessorTable(const PropertyAccessorTable<T, PropertyCount>& aTable) noexcept {
+		for (size_t i = 0; i < PropertyCount; ++i) {
+			if (aTable[i].id != static_cast<int>(i)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template <class T, size_t PropertyCount>
+	inline const string& getPropertyString(const PropertyAccessorTable<T, PropertyCount>& aTable, const T& aItem, int aPropertyName, string& buffer_) noexcept {
+		auto f = aTable[aPropertyName].stringF;
+		if (!f) {
+			dcassert(0);
+			return Util::emptyString;
+		}
+
+		return f(aItem, buffer_);
+	}
+
+	template <class T, size_t PropertyCount>
+	inline double getPropertyNumber(const PropertyAccessorTable<T, PropertyCount>& aTable, const T& aItem, int aPropertyName) noexcept {
+		auto f = aTable[aPropertyName].numberF;
+		if (!f) {
+			dcassert(0);
+			return 0;
+		}
+
+		return f(aItem);
+	}
+
 	template <class T>
 	struct PropertyItemHandler {
 		typedef vector<T> ItemList;
@@ -90,6 +312,9 @@ namespace webserver {
 
 		typedef std::function<int(const T& t1, const T& t2, int aSortProperty)> SorterFunction;
 		typedef std::function<string(const T& aItem, int aPropertyName)> StringFunction;
+
+		// Returns a reference to the value without copying it (formatted values are stored in the supplied buffer)
+		typedef std::function<const string&(const T& aItem, int aPropertyName, string& buffer_)> StringRefFunction;
 		typedef std::function<double(const T& aItem, int aPropertyName)> NumberFunction;
 		typedef std::function<ItemList()> ItemListFunction;
 
@@ -101,7 +326,28 @@ namespace webserver {
 			properties(aProperties),
 			stringF(aStringF), numberF(aNumberF), 
 			customSorterF(aSorterF), jsonF(aJsonF),
-			customFilterF(aFilterF) { }
+			customFilterF(aFilterF), formattedKeys(formatKeys(aProperties)) { }
+
+		PropertyItemHandler(const PropertyList& aProperties,
+			StringRefFunction aStringRefF, NumberFunction aNumberF,
+			SorterFunction aSorterF, CustomPropertySerializer aJsonF,
+			CustomFilterFunction aFilterF = nullptr) :
+
+			properties(aProperties),
+			stringF(toStringFunction(aStringRefF)), stringRefF(aStringRefF), numberF(aNumberF),
+			customSorterF(aSorterF), jsonF(aJsonF),
+			customFilterF(aFilterF), formattedKeys(formatKeys(aProperties)) { }
+
+		// Return the text value of the property
+		// The reference is valid until the buffer is modified (or the item is updated)
+		const string& getString(const T& aItem, int aPropertyName, string& buffer_) const {
+			if (stringRefF) {
+				return stringRefF(aItem, aPropertyName, buffer_);
+			}
+
+			buffer_ = stringF(aItem, aPropertyName);
+			return buffer_;
+		}
 
 		// Information about each property
 		const PropertyList& properties;
@@ -109,6 +355,9 @@ namespace webserver {
 		// Return std::string value of the property
 		const StringFunction stringF;
 
+		// Return the property value without copying it (optional, getString should be preferred)
+		const StringRefFunction stringRefF;
+
 		// Return double value of the property
 		const NumberFunction numberF;
 
@@ -120,6 +369,46 @@ namespace webserver {
 
 		// Returns true if the item matches filter
 		const CustomFilterFunction customFilterF;
+
+		// Escaped property names for JsonWriter::writeFormattedKey
+		const StringList formattedKeys;
+	private:
+		static StringFunction toStringFunction(const StringRefFunction& aStringRefF) {
+			return [aStringRefF](const T& aItem, int aPropertyName) {
+				string buffer;
+				return string(aStringRefF(aItem, aPropertyName, buffer));
+			};
+		}
+
+		static StringList formatKeys(const PropertyList& aProperties) {
+			StringList ret;
+			for (const auto& prop : aProperties) {
+				ret.push_back(JsonWriter::formatKey(prop.name));
+			}
+
+			return ret;
+		}
+	};
+
+	// Access to the text and numeric property values when filtering and sorting items
+	// The values are read through the accessor table when one is given and through the item handler otherwise
+	template <class T, size_t PropertyCount, const PropertyAccessorTable<T, PropertyCount>* Accessors>
+	struct PropertyValues {
+		static double getNumber(const PropertyItemHandler<T>& aHandler, const T& aItem, int aPropertyName) {
+			if constexpr (Accessors != nullptr) {
+				return getPropertyNumber(*Accessors, aItem, aPropertyName);
+			} else {
+				return aHandler.numberF(aItem, aPropertyName);
+			}
+		}
+
+		static const string& getString(const PropertyItemHandler<T>& aHandler, const T& aItem, int aPropertyName, string& buffer_) {
+			if constexpr (Accessors != nullptr) {
+				return getPropertyString(*Accessors, aItem, aPropertyName, buffer_);
+			} else {
+				return aHandler.getString(aItem, aPropertyName, buffer_);
+			}
+		}
 	};
 }
 
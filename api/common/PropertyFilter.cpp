@@ -20,6 +20,8 @@
 
 #include <api/common/PropertyFilter.h>
 
+#include <airdcpp/StringTokenizer.h>
+#include <airdcpp/Text.h>
 #include <airdcpp/TimerManager.h>
 #include <airdcpp/Util.h>
 
@@ -50,8 +52,18 @@ namespace webserver {
 		inverse = aInverse;
 	}
 
-	void PropertyFilter::prepare(const string& aPattern, int aMethod, int aProperty) {
+	bool PropertyFilter::prepare(const string& aPattern, int aMethod, int aProperty) {
 		WLock l(cs);
+
+		// Previous state
+		auto wasEmpty = empty();
+		auto oldProgram = program;
+		auto oldPattern = matcher.pattern;
+		auto oldMethod = defMethod;
+		auto oldProperty = currentFilterProperty;
+		auto oldType = type;
+		auto oldNumericMatcher = numericMatcher;
+
 		setPattern(aPattern);
 		setFilterMethod(static_cast<StringMatch::Method>(aMethod));
 		setFilterProperty(aProperty);
@@ -100,57 +112,165 @@ namespace webserver {
 			type = TYPE_NUMERIC_OTHER;
 			numericMatcher = Util::toDouble(matcher.pattern);
 		}
+
+		compile();
+
+		if (inverse) {
+			// Narrower pattern would match more items
+			return false;
+		}
+
+		if (wasEmpty || empty()) {
+			return wasEmpty;
+		}
+
+		return isNarrowerThan(oldProgram, oldPattern, oldMethod, oldProperty, oldType, oldNumericMatcher);
+	}
+
+	bool PropertyFilter::isNarrowerThan(const Program& aOld, const string& aOldPattern, StringMatch::Method aOldMethod, int aOldProperty, FilterPropertyType aOldType, double aOldNumericMatcher) const noexcept {
+		if (aOld.operation != program.operation || aOldProperty != currentFilterProperty || aOldType != type || aOldMethod != defMethod) {
+			return false;
+		}
+
+		switch (program.operation) {
+			case Program::OP_PARTIAL_TEXT: {
+				// All items matching the new terms must also contain each of the old terms
+				return std::all_of(aOld.lowerTerms.begin(), aOld.lowerTerms.end(), [this](const string& aOldTerm) {
+					return std::any_of(program.lowerTerms.begin(), program.lowerTerms.end(), [&](const string& aNewTerm) {
+						return aNewTerm.find(aOldTerm) != string::npos;
+					});
+				});
+			}
+			case Program::OP_NUMERIC: {
+				if (aOld.numericMode != program.numericMode) {
+					return false;
+				}
+
+				switch (program.numericMode) {
+					case GREATER_EQUAL:
+					case GREATER: return numericMatcher >= aOldNumericMatcher;
+					case LESS_EQUAL:
+					case LESS: return numericMatcher <= aOldNumericMatcher;
+					default: return numericMatcher == aOldNumericMatcher;
+				}
+			}
+			case Program::OP_TEXT:
+			case Program::OP_CUSTOM:
+			default: {
+				// Unchanged filter
+				return matcher.pattern == aOldPattern && numericMatcher == aOldNumericMatcher;
+			}
+		}
+	}
+
+	string PropertyFilter::getStateKeyUnsafe() const noexcept {
+		return Util::toString(id) + ":" + Util::toString(defMethod) + ":" + Util::toString(currentFilterProperty) + ":" + 
+			Util::toString(numComparisonMode) + ":" + (inverse ? "1" : "0") + ":" + Util::toString(matcher.pattern.size()) + ":" + matcher.pattern + ";";
 	}
 
-	bool PropertyFilter::match(const NumericFunction& numericF, const InfoFunction& infoF, const CustomFilterFunction& aCustomF) const {
-		if (empty())
-			return true;
+	void PropertyFilter::compile() noexcept {
+		program = Program();
+
+		auto addProperties = [this](FilterPropertyType aType) {
+			for (const auto& p : propertyTypes) {
+				if (p.filterType == aType) {
+					program.properties.push_back(p.id);
+				}
+			}
+		};
 
-		bool hasMatch = false;
+		bool isText = false;
 		if (currentFilterProperty < 0 || currentFilterProperty >= propertyCount) {
 			// Any column
-			if (defMethod < StringMatch::METHOD_LAST && numComparisonMode == LAST) {
-				for (auto i = 0; i < propertyCount; ++i) {
-					if (propertyTypes[i].filterType == type && matchText(i, infoF)) {
-						hasMatch = true;
-						break;
-					}
-				}
+			isText = defMethod < StringMatch::METHOD_LAST && numComparisonMode == LAST;
+			addProperties(type);
+		} else {
+			auto filterType = propertyTypes[currentFilterProperty].filterType;
+			program.properties.push_back(currentFilterProperty);
+			if (filterType == TYPE_LIST_NUMERIC || filterType == TYPE_LIST_TEXT) {
+				// No default matcher for list properies
+				program.operation = Program::OP_CUSTOM;
 			} else {
-				for (auto i = 0; i < propertyCount; ++i) {
-					if (type == propertyTypes[i].filterType && matchNumeric(i, numericF)) {
-						hasMatch = true;
-						break;
+				isText = filterType == TYPE_TEXT;
+			}
+		}
+
+		if (program.operation == Program::OP_CUSTOM || isText) {
+			if (type == TYPE_TEXT) {
+				matcher.setMethod(defMethod);
+				matcher.prepare();
+			}
+
+			if (isText) {
+				program.operation = Program::OP_TEXT;
+				if (defMethod == StringMatch::PARTIAL) {
+					// Matching against pre-lowercased terms avoids lowercasing the pattern for each item
+					program.operation = Program::OP_PARTIAL_TEXT;
+					StringTokenizer<string> st(matcher.pattern, ' ');
+					for (const auto& term : st.getTokens()) {
+						if (!term.empty()) {
+							program.lowerTerms.push_back(Text::toLower(term));
+						}
 					}
 				}
 			}
-		} else if (propertyTypes[currentFilterProperty].filterType == TYPE_LIST_NUMERIC || propertyTypes[currentFilterProperty].filterType == TYPE_LIST_TEXT) {
-			// No default matcher for list properies
-			hasMatch = aCustomF(currentFilterProperty, matcher, numericMatcher);
-		} else if (propertyTypes[currentFilterProperty].filterType == TYPE_TEXT) {
-			hasMatch = matchText(currentFilterProperty, infoF);
-		} else {
-			hasMatch = matchNumeric(currentFilterProperty, numericF);
+
+			return;
+		}
+
+		program.operation = Program::OP_NUMERIC;
+		program.numericMode = numComparisonMode == LAST ? EQUAL : numComparisonMode;
+		if (type == TYPE_TIME) {
+			// Inverse the match for time periods (smaller number = older age)
+			switch (program.numericMode) {
+				case GREATER_EQUAL: program.numericMode = LESS_EQUAL; break;
+				case LESS_EQUAL: program.numericMode = GREATER_EQUAL; break;
+				case GREATER: program.numericMode = LESS; break;
+				case LESS: program.numericMode = GREATER; break;
+				default: break;
+			}
 		}
-		return inverse ? !hasMatch : hasMatch;
 	}
 
-	bool PropertyFilter::matchText(int aProperty, const InfoFunction& infoF) const {
-		return matcher.match(infoF(aProperty));
+	string& PropertyFilter::getTextBuffer() noexcept {
+		static thread_local string buffer;
+		return buffer;
+	}
+
+	// Case-insensitive search for a lowercased pattern
+	static bool containsLower(const string& aText, const string& aLowerPattern) noexcept {
+		auto isAscii = std::all_of(aText.begin(), aText.end(), [](char c) { return (static_cast<uint8_t>(c) & 0x80) == 0; });
+		if (!isAscii) {
+			static thread_local string lowerText;
+			return Text::toLower(aText, lowerText).find(aLowerPattern) != string::npos;
+		}
+
+		auto i = std::search(aText.begin(), aText.end(), aLowerPattern.begin(), aLowerPattern.end(), [](char aTextChar, char aPatternChar) {
+			return (aTextChar >= 'A' && aTextChar <= 'Z' ? aTextChar + ('a' - 'A') : aTextChar) == aPatternChar;
+		});
+
+		return i != aText.end() || aLowerPattern.empty();
 	}
 
-	bool PropertyFilter::matchNumeric(int aProperty, const NumericFunction& numericF) const {
-		auto toCompare = numericF(aProperty);
-		switch (numComparisonMode) {
-			case NOT_EQUAL: return toCompare != numericMatcher;
+	bool PropertyFilter::matchText(const string& aValue) const {
+		if (program.operation == Program::OP_PARTIAL_TEXT) {
+			return std::all_of(program.lowerTerms.begin(), program.lowerTerms.end(), [&](const string& aTerm) {
+				return containsLower(aValue, aTerm);
+			});
+		}
+
+		return matcher.match(aValue);
+	}
 
-			// inverse the match for time periods (smaller number = older age)
-			case GREATER_EQUAL: return type == TYPE_TIME ? toCompare <= numericMatcher : toCompare >= numericMatcher;
-			case LESS_EQUAL: return type == TYPE_TIME ? toCompare >= numericMatcher : toCompare <= numericMatcher;
-			case GREATER: return type == TYPE_TIME ? toCompare < numericMatcher : toCompare > numericMatcher; break;
-			case LESS: return type == TYPE_TIME ? toCompare > numericMatcher : toCompare < numericMatcher; break;
+	bool PropertyFilter::matchNumeric(double aValue) const {
+		switch (program.numericMode) {
+			case NOT_EQUAL: return aValue != numericMatcher;
+			case GREATER_EQUAL: return aValue >= numericMatcher;
+			case LESS_EQUAL: return aValue <= numericMatcher;
+			case GREATER: return aValue > numericMatcher;
+			case LESS: return aValue < numericMatcher;
 			case EQUAL:
-			default: return toCompare == numericMatcher;
+			default: return aValue == numericMatcher;
 		}
 	}
 
@@ -31,8 +31,6 @@ namespace webserver {
 	class PropertyFilter : boost::noncopyable {
 	public:
 		typedef std::function<std::string(int)> InfoFunction;
-		typedef std::function<double(int)> NumericFunction;
-		typedef std::function<bool(int, const StringMatch&, double)> CustomFilterFunction;
 
 		typedef shared_ptr<PropertyFilter> Ptr;
 		typedef vector<Ptr> List;
@@ -63,14 +61,31 @@ namespace webserver {
 
 			typedef Matcher<FilterT> MatcherT;
 			typedef vector<MatcherT> List;
-			static inline bool match(const List& prep, const NumericFunction& aNumericF, const InfoFunction& aStringF, const CustomFilterFunction& aCustomF) {
+
+			// The value functions are templates so that they can be inlined:
+			// aNumericF(int aProperty) returns the numeric value of the property
+			// aTextF(int aProperty, string& buffer_) returns the text value of the property (the value may be written in the supplied buffer that is reused between the calls)
+			// aCustomF(int aProperty, const StringMatch& aTextMatcher, double aNumericMatcher) returns true if the item matches
+			template<typename NumericF, typename TextF, typename CustomF>
+			static inline bool match(const List& prep, const NumericF& aNumericF, const TextF& aTextF, const CustomF& aCustomF) {
 				return std::all_of(prep.begin(), prep.end(), [&](const Matcher& aMatcher) { 
-					return aMatcher.filter->match(aNumericF, aStringF, aCustomF); 
+					return aMatcher.filter->match(aNumericF, aTextF, aCustomF); 
 				});
 			}
 
-			static inline bool match(const MatcherT& prep, const NumericFunction& aNumericF, const InfoFunction& aStringF, const CustomFilterFunction& aCustomF) {
-				return prep.filter->match(aNumericF, aStringF, aCustomF);
+			template<typename NumericF, typename TextF, typename CustomF>
+			static inline bool match(const MatcherT& prep, const NumericF& aNumericF, const TextF& aTextF, const CustomF& aCustomF) {
+				return prep.filter->match(aNumericF, aTextF, aCustomF);
+			}
+
+			// Returns a key identifying the current state of all filters in the list
+			static inline string getStateKey(const List& prep) {
+				string ret;
+				for (const auto& m : prep) {
+					ret += m.filter->getStateKeyUnsafe();
+				}
+
+				return ret;
 			}
 		private:
 			FilterT filter;
@@ -80,7 +95,9 @@ namespace webserver {
 
 		PropertyFilter(const PropertyList& aPropertyTypes);
 
-		void prepare(const string& aPattern, int aMethod, int aProperty);
+		// Returns true if the new filter can't match any items that weren't matched by the previous filter
+		// (e.g. a character was appended to a partial matching pattern or a numeric bound was tightened)
+		bool prepare(const string& aPattern, int aMethod, int aProperty);
 
 		bool empty() const noexcept;
 		void clear() noexcept;
@@ -96,9 +113,46 @@ namespace webserver {
 		friend class Preparation;
 
 		mutable SharedMutex cs;
-		bool match(const NumericFunction& numericF, const InfoFunction& infoF, const CustomFilterFunction& aCustomF) const;
-		bool matchText(int aProperty, const InfoFunction& infoF) const;
-		bool matchNumeric(int aProperty, const NumericFunction& infoF) const;
+
+		template<typename NumericF, typename TextF, typename CustomF>
+		bool match(const NumericF& aNumericF, const TextF& aTextF, const CustomF& aCustomF) const {
+			if (empty())
+				return true;
+
+			bool hasMatch = false;
+			switch (program.operation) {
+				case Program::OP_CUSTOM: {
+					hasMatch = aCustomF(program.properties.front(), matcher, numericMatcher);
+					break;
+				}
+				case Program::OP_NUMERIC: {
+					hasMatch = std::any_of(program.properties.begin(), program.properties.end(), [&](int aProperty) {
+						return matchNumeric(aNumericF(aProperty));
+					});
+					break;
+				}
+				case Program::OP_TEXT:
+				case Program::OP_PARTIAL_TEXT: {
+					auto& buffer = getTextBuffer();
+					hasMatch = std::any_of(program.properties.begin(), program.properties.end(), [&](int aProperty) {
+						return matchText(aTextF(aProperty, buffer));
+					});
+					break;
+				}
+			}
+
+			return inverse ? !hasMatch : hasMatch;
+		}
+
+		bool matchText(const string& aValue) const;
+		bool matchNumeric(double aValue) const;
+
+		// Reused for all items matched by this thread
+		static string& getTextBuffer() noexcept;
+
+		void compile() noexcept;
+
+		string getStateKeyUnsafe() const noexcept;
 
 		void setPattern(const std::string& aText) noexcept;
 		void setFilterProperty(int aFilterProperty) noexcept;
@@ -137,6 +191,32 @@ namespace webserver {
 		};
 
 		FilterMode numComparisonMode;
+
+		// The filter compiled into a form that is cheap to evaluate for each item
+		// Column types and the comparison mode are resolved when the filter is prepared
+		struct Program {
+			enum Operation {
+				OP_TEXT,
+				OP_PARTIAL_TEXT,
+				OP_NUMERIC,
+				OP_CUSTOM
+			};
+
+			Operation operation = OP_TEXT;
+
+			// Properties to check (any of them must match)
+			vector<int> properties;
+
+			// Lowercased terms for partial matching (all of them must be found)
+			StringList lowerTerms;
+
+			// Comparison mode with the inversion for time periods applied
+			FilterMode numericMode = EQUAL;
+		};
+
+		Program program;
+
+		bool isNarrowerThan(const Program& aOld, const string& aOldPattern, StringMatch::Method aOldMethod, int aOldProperty, FilterPropertyType aOldType, double aOldNumericMatcher) const noexcept;
 	};
 }
 
@@ -0,0 +1,170 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_PROPERTY_FRAGMENT_CACHE_H
+#define DCPLUSPLUS_DCPP_PROPERTY_FRAGMENT_CACHE_H
+
+#include "stdinc.h"
+
+#include <api/common/Property.h>
+
+#include <airdcpp/CriticalSection.h>
+
+#include <array>
+#include <unordered_map>
+
+
+namespace webserver {
+
+	// Serialized property values (fragments) that are shared between all list views of the same item type
+	//
+	// The values don't expire by themselves: the views must invalidate the updated properties when they receive
+	// item update notifications and remove their items when the items leave the view or the view is stopped or destroyed.
+	// Each invalidation bumps a version counter and fragments are stored only if the version didn't change while
+	// the values were being serialized.
+	template<class T>
+	class PropertyFragmentCache {
+	public:
+		typedef vector<pair<int, string>> FragmentList;
+
+		struct PendingItem {
+			PendingItem(const T& aItem, uint32_t aVersion, FragmentList&& aFragments) noexcept :
+				item(aItem), version(aVersion), fragments(std::move(aFragments)) { }
+
+			T item;
+			uint32_t version;
+			FragmentList fragments;
+		};
+
+		typedef vector<PendingItem> PendingList;
+
+		// Writes the cached property values (with keys) and returns the IDs of properties that weren't cached
+		// The returned version must be passed when storing the missing values
+		PropertyIdSet write(const T& aItem, const PropertyIdSet& aPropertyIds, const StringList& aFormattedKeys, JsonWriter& writer_, uint32_t& version_) const noexcept {
+			RLock l(cs);
+			version_ = versions[getStripe(aItem)];
+
+			auto i = entries.find(getKey(aItem));
+			if (i == entries.end()) {
+				return aPropertyIds;
+			}
+
+			PropertyIdSet missing;
+			for (auto id : aPropertyIds) {
+				if (!i->second.cached.contains(id)) {
+					missing.insert(id);
+					continue;
+				}
+
+				writer_.writeFormattedKey(aFormattedKeys[id]);
+				writer_.writeRaw(i->second.fragments[id]);
+			}
+
+			return missing;
+		}
+
+		void store(PendingList&& aItems) noexcept {
+			WLock l(cs);
+			for (auto& p : aItems) {
+				if (versions[getStripe(p.item)] != p.version) {
+					// Invalidated while serializing
+					continue;
+				}
+
+				auto& entry = entries.try_emplace(getKey(p.item), p.item).first->second;
+				for (auto& f : p.fragments) {
+					if (entry.fragments.size() <= static_cast<size_t>(f.first)) {
+						entry.fragments.resize(f.first + 1);
+					}
+
+					entry.fragments[f.first] = std::move(f.second);
+					entry.cached.insert(f.first);
+				}
+			}
+		}
+
+		void invalidate(const T& aItem, const PropertyIdSet& aPropertyIds) noexcept {
+			WLock l(cs);
+			versions[getStripe(aItem)]++;
+
+			auto i = entries.find(getKey(aItem));
+			if (i != entries.end()) {
+				for (auto id : aPropertyIds) {
+					i->second.cached.erase(id);
+				}
+			}
+		}
+
+		void remove(const T& aItem) noexcept {
+			WLock l(cs);
+			removeUnsafe(aItem);
+		}
+
+		template<class ContainerT>
+		void remove(const ContainerT& aItems) noexcept {
+			WLock l(cs);
+			if (entries.empty()) {
+				return;
+			}
+
+			for (const auto& item : aItems) {
+				removeUnsafe(item);
+			}
+		}
+
+		size_t size() const noexcept {
+			RLock l(cs);
+			return entries.size();
+		}
+	private:
+		struct Entry {
+			explicit Entry(const T& aItem) noexcept : item(aItem) { }
+
+			// Keeps the address reserved for the item
+			const T item;
+
+			PropertyIdSet cached;
+			StringList fragments;
+		};
+
+		void removeUnsafe(const T& aItem) noexcept {
+			versions[getStripe(aItem)]++;
+			entries.erase(getKey(aItem));
+		}
+
+		static const void* getKey(const T& aItem) noexcept {
+			return static_cast<const void*>(&*aItem);
+		}
+
+		static size_t getStripe(const T& aItem) noexcept {
+			auto hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(getKey(aItem))) * 0x9E3779B97F4A7C15ULL;
+			return static_cast<size_t>(hash >> 56);
+		}
+
+		// Items are identified by their address (the entry holds a reference so that the address can't be reused
+		// for another item while the entry exists)
+		std::unordered_map<const void*, Entry> entries;
+
+		// Invalidation counters for groups of items (invalidating items without cached values doesn't need to allocate entries)
+		std::array<uint32_t, 256> versions = { };
+
+		mutable SharedMutex cs;
+	};
+}
+
+#endif
@@ -0,0 +1,444 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_RANKED_ITEM_LIST_H
+#define DCPLUSPLUS_DCPP_RANKED_ITEM_LIST_H
+
+#include <unordered_map>
+
+
+namespace webserver {
+
+	// Hashes items by the address of the pointed object (works with all smart pointer types)
+	template<class T>
+	struct ItemPointerHash {
+		size_t operator()(const T& aItem) const noexcept {
+			return std::hash<const void*>()(static_cast<const void*>(&*aItem));
+		}
+	};
+
+	// Ordered list of unique items with O(log n) positional access
+	//
+	// The items are stored in a treap where each node is augmented with the size of its subtree,
+	// which allows finding, inserting and erasing items by their position in logarithmic time.
+	// A hash index from item to node is maintained to make position lookups for an item cheap.
+	template<class T>
+	class RankedItemList {
+		struct Node {
+			Node(const T& aItem, uint32_t aPriority) : item(aItem), priority(aPriority) { }
+
+			T item;
+			uint32_t priority;
+			size_t size = 1;
+
+			Node* left = nullptr;
+			Node* right = nullptr;
+			Node* parent = nullptr;
+		};
+
+		typedef std::unordered_map<T, Node*, ItemPointerHash<T>> NodeMap;
+	public:
+		typedef vector<T> ItemList;
+
+		class const_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const T* pointer;
+			typedef const T& reference;
+
+			const_iterator(const Node* aNode = nullptr) noexcept : node(aNode) { }
+
+			reference operator*() const noexcept { return node->item; }
+			pointer operator->() const noexcept { return &node->item; }
+
+			const_iterator& operator++() noexcept {
+				node = successor(node);
+				return *this;
+			}
+
+			const_iterator operator++(int) noexcept {
+				auto ret = *this;
+				node = successor(node);
+				return ret;
+			}
+
+			bool operator==(const const_iterator& aOther) const noexcept { return node == aOther.node; }
+			bool operator!=(const const_iterator& aOther) const noexcept { return node != aOther.node; }
+		private:
+			const Node* node;
+		};
+
+		RankedItemList() { }
+
+		RankedItemList(RankedItemList&& aOther) noexcept {
+			swap(aOther);
+		}
+
+		RankedItemList& operator=(RankedItemList&& aOther) noexcept {
+			swap(aOther);
+			return *this;
+		}
+
+		RankedItemList(const RankedItemList&) = delete;
+		RankedItemList& operator=(const RankedItemList&) = delete;
+
+		~RankedItemList() {
+			clear();
+		}
+
+		size_t size() const noexcept {
+			return nodes.size();
+		}
+
+		bool empty() const noexcept {
+			return nodes.empty();
+		}
+
+		const_iterator begin() const noexcept {
+			return const_iterator(leftmost(root));
+		}
+
+		const_iterator end() const noexcept {
+			return const_iterator();
+		}
+
+		void clear() noexcept {
+			for (const auto& n : nodes) {
+				delete n.second;
+			}
+
+			nodes.clear();
+			root = nullptr;
+		}
+
+		void swap(RankedItemList& aOther) noexcept {
+			std::swap(root, aOther.root);
+			std::swap(seed, aOther.seed);
+			nodes.swap(aOther.nodes);
+		}
+
+		// Replace the content with items that are already in the wanted order (O(n))
+		// Duplicate items are ignored
+		void assign(const ItemList& aItems) {
+			clear();
+			nodes.reserve(aItems.size());
+
+			// Build a cartesian tree from the sequence by using random priorities
+			vector<Node*> rightSpine;
+			for (const auto& item : aItems) {
+				auto node = createNode(item);
+				if (!node) {
+					continue;
+				}
+
+				Node* last = nullptr;
+				while (!rightSpine.empty() && rightSpine.back()->priority < node->priority) {
+					last = rightSpine.back();
+					rightSpine.pop_back();
+				}
+
+				node->left = last;
+				if (last) {
+					last->parent = node;
+				}
+
+				if (!rightSpine.empty()) {
+					rightSpine.back()->right = node;
+					node->parent = rightSpine.back();
+				}
+
+				rightSpine.push_back(node);
+			}
+
+			root = rightSpine.empty() ? nullptr : rightSpine.front();
+			updateSizes(root);
+		}
+
+		// Returns all items in order
+		ItemList toList() const {
+			ItemList ret;
+			ret.reserve(size());
+			std::copy(begin(), end(), back_inserter(ret));
+			return ret;
+		}
+
+		// Stable sort with the supplied comparator (O(n log n))
+		template<class CompareT>
+		void sort(const CompareT& aLess) {
+			auto items = toList();
+			std::stable_sort(items.begin(), items.end(), aLess);
+			assign(items);
+		}
+
+		// Insert the item after all items that don't compare greater than it (equals to std::upper_bound)
+		// Returns the position of the inserted item or -1 if the item exists in the list already
+		template<class CompareT>
+		int64_t insert(const T& aItem, const CompareT& aLess) {
+			auto node = createNode(aItem);
+			if (!node) {
+				return -1;
+			}
+
+			Node *left = nullptr, *right = nullptr;
+			splitByValue(root, aItem, aLess, left, right);
+
+			auto pos = static_cast<int64_t>(getSize(left));
+			root = merge(merge(left, node), right);
+			root->parent = nullptr;
+			return pos;
+		}
+
+		// Insert the item in the specified position
+		// Returns false if the item exists in the list already
+		bool insertAt(const T& aItem, size_t aPos) {
+			auto node = createNode(aItem);
+			if (!node) {
+				return false;
+			}
+
+			Node *left = nullptr, *right = nullptr;
+			splitByPosition(root, min(aPos, size() - 1), left, right);
+
+			root = merge(merge(left, node), right);
+			root->parent = nullptr;
+			return true;
+		}
+
+		// Returns the old position of the item or -1 if the item wasn't found
+		int64_t erase(const T& aItem) noexcept {
+			auto i = nodes.find(aItem);
+			if (i == nodes.end()) {
+				return -1;
+			}
+
+			auto node = i->second;
+			auto pos = getRank(node);
+
+			Node *left = nullptr, *mid = nullptr, *right = nullptr;
+			splitByPosition(root, pos, left, right);
+			splitByPosition(right, 1, mid, right);
+			dcassert(mid == node);
+
+			root = merge(left, right);
+			if (root) {
+				root->parent = nullptr;
+			}
+
+			nodes.erase(i);
+			delete node;
+			return static_cast<int64_t>(pos);
+		}
+
+		bool contains(const T& aItem) const noexcept {
+			return nodes.find(aItem) != nodes.end();
+		}
+
+		// Returns -1 if the item wasn't found
+		int64_t getPosition(const T& aItem) const noexcept {
+			auto i = nodes.find(aItem);
+			if (i == nodes.end()) {
+				return -1;
+			}
+
+			return static_cast<int64_t>(getRank(i->second));
+		}
+
+		// The position must be valid
+		const T& at(size_t aPos) const noexcept {
+			return findByPosition(aPos)->item;
+		}
+
+		// Iterator pointing to the item in the specified position (or end if the position is out of range)
+		const_iterator fromPosition(size_t aPos) const noexcept {
+			if (aPos >= size()) {
+				return end();
+			}
+
+			return const_iterator(findByPosition(aPos));
+		}
+
+		// Append maximum of aCount items starting from the specified position (O(log n + aCount))
+		template<class OutputIt>
+		void copyRange(size_t aStart, size_t aCount, OutputIt aOutput) const {
+			auto i = fromPosition(aStart);
+			for (; aCount > 0 && i != end(); --aCount, ++i) {
+				*aOutput++ = *i;
+			}
+		}
+	private:
+		Node* createNode(const T& aItem) {
+			auto node = new Node(aItem, nextPriority());
+			if (!nodes.emplace(aItem, node).second) {
+				delete node;
+				return nullptr;
+			}
+
+			return node;
+		}
+
+		uint32_t nextPriority() noexcept {
+			// xorshift32
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			return seed;
+		}
+
+		static size_t getSize(const Node* aNode) noexcept {
+			return aNode ? aNode->size : 0;
+		}
+
+		static void update(Node* aNode) noexcept {
+			aNode->size = 1 + getSize(aNode->left) + getSize(aNode->right);
+			if (aNode->left) {
+				aNode->left->parent = aNode;
+			}
+
+			if (aNode->right) {
+				aNode->right->parent = aNode;
+			}
+		}
+
+		static size_t updateSizes(Node* aNode) noexcept {
+			if (!aNode) {
+				return 0;
+			}
+
+			aNode->size = 1 + updateSizes(aNode->left) + updateSizes(aNode->right);
+			return aNode->size;
+		}
+
+		static Node* merge(Node* aLeft, Node* aRight) noexcept {
+			if (!aLeft) {
+				return aRight;
+			}
+
+			if (!aRight) {
+				return aLeft;
+			}
+
+			if (aLeft->priority > aRight->priority) {
+				aLeft->right = merge(aLeft->right, aRight);
+				update(aLeft);
+				return aLeft;
+			}
+
+			aRight->left = merge(aLeft, aRight->left);
+			update(aRight);
+			return aRight;
+		}
+
+		// Left tree will contain aPos first items
+		static void splitByPosition(Node* aNode, size_t aPos, Node*& left_, Node*& right_) noexcept {
+			if (!aNode) {
+				left_ = right_ = nullptr;
+				return;
+			}
+
+			if (getSize(aNode->left) < aPos) {
+				splitByPosition(aNode->right, aPos - getSize(aNode->left) - 1, aNode->right, right_);
+				left_ = aNode;
+			} else {
+				splitByPosition(aNode->left, aPos, left_, aNode->left);
+				right_ = aNode;
+			}
+
+			update(aNode);
+			aNode->parent = nullptr;
+		}
+
+		// Right tree will contain items comparing greater than aItem
+		template<class CompareT>
+		static void splitByValue(Node* aNode, const T& aItem, const CompareT& aLess, Node*& left_, Node*& right_) {
+			if (!aNode) {
+				left_ = right_ = nullptr;
+				return;
+			}
+
+			if (aLess(aItem, aNode->item)) {
+				splitByValue(aNode->left, aItem, aLess, left_, aNode->left);
+				right_ = aNode;
+			} else {
+				splitByValue(aNode->right, aItem, aLess, aNode->right, right_);
+				left_ = aNode;
+			}
+
+			update(aNode);
+			aNode->parent = nullptr;
+		}
+
+		static size_t getRank(const Node* aNode) noexcept {
+			auto rank = getSize(aNode->left);
+			for (; aNode->parent; aNode = aNode->parent) {
+				if (aNode->parent->right == aNode) {
+					rank += getSize(aNode->parent->left) + 1;
+				}
+			}
+
+			return rank;
+		}
+
+		const Node* findByPosition(size_t aPos) const noexcept {
+			auto node = root;
+			while (node) {
+				auto leftSize = getSize(node->left);
+				if (aPos < leftSize) {
+					node = node->left;
+				} else if (aPos == leftSize) {
+					return node;
+				} else {
+					aPos -= leftSize + 1;
+					node = node->right;
+				}
+			}
+
+			dcassert(0);
+			return nullptr;
+		}
+
+		static const Node* leftmost(const Node* aNode) noexcept {
+			if (aNode) {
+				while (aNode->left) {
+					aNode = aNode->left;
+				}
+			}
+
+			return aNode;
+		}
+
+		static const Node* successor(const Node* aNode) noexcept {
+			if (aNode->right) {
+				return leftmost(aNode->right);
+			}
+
+			while (aNode->parent && aNode->parent->right == aNode) {
+				aNode = aNode->parent;
+			}
+
+			return aNode->parent;
+		}
+
+		Node* root = nullptr;
+		NodeMap nodes;
+		uint32_t seed = 2463534242;
+	};
+}
+
+#endif
@@ -157,41 +157,99 @@ namespace webserver {
 			return serializeRange(beginIter, endIter, aF);
 		}
 
-		// Serialize a list of items provider by the handler with a custom range
+		// Write a list of items provider by the handler with a custom range
 		// Throws for invalid range parameters
 		template <class T, class ContainerT>
-		static json serializeItemList(int aStart, int aCount, const PropertyItemHandler<T>& aHandler, const ContainerT& aItems) {
-			return Serializer::serializeFromPosition(aStart, aCount, aItems, [&aHandler](const T& aItem) {
-				return Serializer::serializeItem(aItem, aHandler);
-			});
+		static void serializeItemList(JsonWriter& writer_, int aStart, int aCount, const PropertyItemHandler<T>& aHandler, const ContainerT& aItems) {
+			auto listSize = static_cast<int>(std::distance(aItems.begin(), aItems.end()));
+			if (listSize == 0) {
+				writer_.startArray();
+				writer_.endArray();
+				return;
+			}
+
+			if (aStart >= listSize || aCount <= 0) {
+				throw std::domain_error("Invalid range");
+			}
+
+			auto beginIter = aItems.begin();
+			std::advance(beginIter, aStart);
+
+			auto endIter = beginIter;
+			std::advance(endIter, min(listSize - aStart, aCount));
+
+			writeItemRange(writer_, beginIter, endIter, aHandler);
 		}
 
-		// Serialize a list of items provider by the handler
+		// Write a list of items provider by the handler
 		template <class T, class ContainerT>
-		static json serializeItemList(const PropertyItemHandler<T>& aHandler, const ContainerT& aItems) {
-			return Serializer::serializeRange(aItems.begin(), aItems.end(), [&aHandler](const T& aItem) {
-				return Serializer::serializeItem(aItem, aHandler);
-			});
+		static void serializeItemList(JsonWriter& writer_, const PropertyItemHandler<T>& aHandler, const ContainerT& aItems) {
+			writeItemRange(writer_, aItems.begin(), aItems.end(), aHandler);
 		}
 
-		// Serialize item with ID and all properties
+		// Write item with ID and specified properties
 		template <class T>
-		static json serializeItem(const T& aItem, const PropertyItemHandler<T>& aHandler) noexcept {
-			return serializePartialItem(aItem, aHandler, toPropertyIdSet(aHandler.properties));
+		static void serializePartialItem(JsonWriter& writer_, const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) {
+			writer_.startObject();
+			serializeProperties(writer_, aItem, aHandler, aPropertyIds);
+			writer_.writeKey("id");
+			writer_.writeJson(aItem->getToken());
+			writer_.endObject();
 		}
 
-		// Serialize item with ID and specified properties
+		// Write specified item properties (without the ID) into an object that has been started by the caller
+		template <class T>
+		static void serializeProperties(JsonWriter& writer_, const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) {
+			for (auto id : aPropertyIds) {
+				writer_.writeFormattedKey(aHandler.formattedKeys[id]);
+				serializePropertyValue(writer_, aItem, aHandler, id);
+			}
+		}
+
+		// Write the value of a single property (the key must have been written by the caller)
 		template <class T>
-		static json serializePartialItem(const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) noexcept {
-			auto j = serializeProperties(aItem, aHandler, aPropertyIds);
+		static void serializePropertyValue(JsonWriter& writer_, const T& aItem, const PropertyItemHandler<T>& aHandler, int aPropertyId) {
+			switch (aHandler.properties[aPropertyId].serializationMethod) {
+			case SERIALIZE_NUMERIC: {
+				writer_.writeNumber(aHandler.numberF(aItem, aPropertyId));
+				break;
+			}
+			case SERIALIZE_TEXT: {
+				thread_local string buffer;
+				writer_.writeString(aHandler.getString(aItem, aPropertyId, buffer));
+				break;
+			}
+			case SERIALIZE_BOOL: {
+				writer_.writeBool(aHandler.numberF(aItem, aPropertyId) == 0 ? false : true);
+				break;
+			}
+			case SERIALIZE_CUSTOM: {
+				writer_.writeJson(aHandler.jsonF(aItem, aPropertyId));
+				break;
+			}
+			}
+		}
+
+		// Serialize item with ID and all properties
+		// JsonT can be used for specifying a different JSON type (e.g. EventJson for event data)
+		template <class JsonT = json, class T>
+		static JsonT serializeItem(const T& aItem, const PropertyItemHandler<T>& aHandler) noexcept {
+			return serializePartialItem<JsonT>(aItem, aHandler, toPropertyIdSet(aHandler.properties));
+		}
+
+		// Serialize item with ID and specified properties
+		template <class JsonT = json, class T>
+		static JsonT serializePartialItem(const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) noexcept {
+			auto j = serializeProperties<JsonT>(aItem, aHandler, aPropertyIds);
 			j["id"] = aItem->getToken();
 			return j;
 		}
 
 		// Serialize specified item properties (without the ID)
-		template <class T>
-		static json serializeProperties(const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) noexcept {
-			json j;
+		template <class JsonT = json, class T>
+		static JsonT serializeProperties(const T& aItem, const PropertyItemHandler<T>& aHandler, const PropertyIdSet& aPropertyIds) noexcept {
+			JsonT j;
+			string buffer;
 			for (auto id : aPropertyIds) {
 				const auto& prop = aHandler.properties[id];
 				switch (prop.serializationMethod) {
@@ -200,7 +258,7 @@ namespace webserver {
 					break;
 				}
 				case SERIALIZE_TEXT: {
-					j[prop.name] = aHandler.stringF(aItem, id);
+					j[prop.name] = aHandler.getString(aItem, id, buffer);
 					break;
 				}
 				case SERIALIZE_BOOL: {
@@ -224,6 +282,18 @@ namespace webserver {
 	private:
 		static void appendOnlineUserFlags(const OnlineUserPtr& aUser, StringSet& flags_) noexcept;
 
+		template <class T, class IterT>
+		static void writeItemRange(JsonWriter& writer_, IterT aBegin, IterT aEnd, const PropertyItemHandler<T>& aHandler) {
+			const auto propertyIds = toPropertyIdSet(aHandler.properties);
+
+			writer_.startArray();
+			for (auto i = aBegin; i != aEnd; ++i) {
+				serializePartialItem(writer_, *i, aHandler, propertyIds);
+			}
+
+			writer_.endArray();
+		}
+
 		template <class IterT, class FuncT>
 		static json serializeRange(IterT aBegin, IterT aEnd, FuncT aF) noexcept {
 			return std::accumulate(aBegin, aEnd, json::array(), [&](json& list, const typename iterator_traits<IterT>::value_type& elem) {
@@ -0,0 +1,147 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_SORT_KEY_CACHE_H
+#define DCPLUSPLUS_DCPP_SORT_KEY_CACHE_H
+
+#include <api/common/Property.h>
+#include <api/common/RankedItemList.h>
+
+#include <airdcpp/Util.h>
+
+#include <unordered_map>
+
+
+namespace webserver {
+
+	// Caches the values of the current sort property for each item so that the
+	// comparisons don't need to call the item handler (and allocate strings) every time
+	//
+	// Keys of custom sort properties aren't cached
+	// Not thread safe (comparisons are read-only after calling prepare for the compared items)
+	template<class T, class ValuesT = PropertyValues<T, 0, nullptr>>
+	class SortKeyCache {
+	public:
+		SortKeyCache(const PropertyItemHandler<T>& aItemHandler) : itemHandler(aItemHandler) { }
+
+		// Cached keys are dropped if the property changes
+		void setProperty(int aProperty) noexcept {
+			if (aProperty == property) {
+				return;
+			}
+
+			keys.clear();
+			property = aProperty;
+		}
+
+		int getProperty() const noexcept {
+			return property;
+		}
+
+		// Drops the key if the sort property was updated
+		void onItemUpdated(const T& aItem, const PropertyIdSet& aUpdatedProperties) noexcept {
+			if (aUpdatedProperties.contains(property)) {
+				keys.erase(aItem);
+			}
+		}
+
+		void onItemRemoved(const T& aItem) noexcept {
+			keys.erase(aItem);
+		}
+
+		void clear() noexcept {
+			keys.clear();
+			property = -1;
+		}
+
+		size_t size() const noexcept {
+			return keys.size();
+		}
+
+		// Computes the missing keys for the items so that the following comparisons
+		// won't modify the cache (required when sorting in multiple threads)
+		// Returns false if the items can't be compared concurrently (custom sorters)
+		template<class ContainerT>
+		bool prepare(const ContainerT& aItems) {
+			if (property < 0) {
+				return false;
+			}
+
+			auto sortMethod = itemHandler.properties[property].sortMethod;
+			if (sortMethod != SORT_NUMERIC && sortMethod != SORT_TEXT) {
+				return sortMethod == SORT_NONE;
+			}
+
+			keys.reserve(keys.size() + aItems.size());
+			for (const auto& item : aItems) {
+				getKey(item);
+			}
+
+			return true;
+		}
+
+		// Compares the items by using the current sort property
+		int compareItems(const T& t1, const T& t2) {
+			switch (itemHandler.properties[property].sortMethod) {
+			case SORT_NUMERIC: {
+				return compare(getKey(t1).numeric, getKey(t2).numeric);
+			}
+			case SORT_TEXT: {
+				return Util::DefaultSort(getKey(t1).text.c_str(), getKey(t2).text.c_str());
+			}
+			case SORT_CUSTOM: {
+				return itemHandler.customSorterF(t1, t2, property);
+			}
+			case SORT_NONE: break;
+			default: dcassert(0);
+			}
+
+			return 0;
+		}
+	private:
+		struct SortKey {
+			double numeric = 0;
+			string text;
+		};
+
+		// The returned reference stays valid until the key is removed (rehashing won't invalidate it)
+		const SortKey& getKey(const T& aItem) {
+			auto i = keys.find(aItem);
+			if (i != keys.end()) {
+				return i->second;
+			}
+
+			SortKey key;
+			if (itemHandler.properties[property].sortMethod == SORT_NUMERIC) {
+				key.numeric = ValuesT::getNumber(itemHandler, aItem, property);
+			} else {
+				string buffer;
+				key.text = ValuesT::getString(itemHandler, aItem, property, buffer);
+			}
+
+			return keys.emplace(aItem, std::move(key)).first->second;
+		}
+
+		const PropertyItemHandler<T>& itemHandler;
+
+		int property = -1;
+		std::unordered_map<T, SortKey, ItemPointerHash<T>> keys;
+	};
+}
+
+#endif
@@ -19,7 +19,10 @@
 #ifndef DCPLUSPLUS_DCPP_VIEWTASKS_H
 #define DCPLUSPLUS_DCPP_VIEWTASKS_H
 
-#include <airdcpp/CriticalSection.h>
+#include <api/common/Property.h>
+
+#include <atomic>
+#include <chrono>
 
 
 namespace webserver {
@@ -32,6 +35,10 @@ enum Tasks {
 };
 
 
+// Collects item changes from multiple threads without locking
+//
+// The producers push events to a lock-free stack and the consumer (view timer)
+// takes all pending events at once, coalescing them by item
 template<class T>
 class ItemTasks {
 public:
@@ -51,7 +58,7 @@ public:
 
 			// Merge
 			if (type == aTask.type) {
-				updatedProperties.insert(aTask.updatedProperties.begin(), aTask.updatedProperties.end());
+				updatedProperties |= aTask.updatedProperties;
 				return;
 			}
 
@@ -63,47 +70,148 @@ public:
 
 	typedef map<T, MergeTask> TaskMap;
 
+	// Producer statistics (debug builds only)
+	struct Stats {
+		uint64_t events = 0;
+		uint64_t totalPushTimeNs = 0;
+		uint64_t maxPushTimeNs = 0;
+		uint64_t maxQueueTimeMs = 0;
+	};
+
+	ItemTasks() { }
+	ItemTasks(const ItemTasks&) = delete;
+	ItemTasks& operator=(const ItemTasks&) = delete;
+
+	~ItemTasks() {
+		deleteEvents(head.exchange(nullptr));
+	}
+
 	void addItem(const T& aItem) {
-		WLock l(cs);
-		queueTask(aItem, MergeTask(ADD_ITEM));
+		push(new Event(aItem, MergeTask(ADD_ITEM)));
 	}
 
 	void removeItem(const T& aItem) {
-		WLock l(cs);
-		queueTask(aItem, MergeTask(REMOVE_ITEM));
+		push(new Event(aItem, MergeTask(REMOVE_ITEM)));
 	}
 
 	void updateItem(const T& aItem, const PropertyIdSet& aUpdatedProperties) {
-		WLock l(cs);
-		updatedProperties.insert(aUpdatedProperties.begin(), aUpdatedProperties.end());
-		queueTask(aItem, MergeTask(UPDATE_ITEM, aUpdatedProperties));
+		push(new Event(aItem, MergeTask(UPDATE_ITEM, aUpdatedProperties)));
 	}
 
 	void clear() {
-		WLock l(cs);
-		updatedProperties.clear();
-		tasks.clear();
+		deleteEvents(head.exchange(nullptr, std::memory_order_acquire));
 	}
 
-	void get(typename ItemTasks::TaskMap& tasks_, PropertyIdSet& updatedProperties_) {
-		WLock l(cs);
-		tasks_.swap(tasks);
-		updatedProperties_.swap(updatedProperties);
+	// Takes all pending events and merges them with the existing tasks
+	// Returns the number of events that were handled
+	size_t get(typename ItemTasks::TaskMap& tasks_, PropertyIdSet& updatedProperties_) {
+		auto events = reverse(head.exchange(nullptr, std::memory_order_acquire));
+
+		size_t count = 0;
+#ifdef _DEBUG
+		auto now = std::chrono::steady_clock::now();
+#endif
+		for (auto e = events; e; e = e->next) {
+			count++;
+			if (e->task.type == UPDATE_ITEM) {
+				updatedProperties_ |= e->task.updatedProperties;
+			}
+
+			auto i = tasks_.find(e->item);
+			if (i != tasks_.end()) {
+				i->second.merge(e->task);
+			} else {
+				tasks_.emplace(e->item, e->task);
+			}
+
+#ifdef _DEBUG
+			auto queueTimeMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - e->queued).count());
+			stats.maxQueueTimeMs = max(stats.maxQueueTimeMs, queueTimeMs);
+#endif
+		}
+
+		deleteEvents(events);
+		return count;
 	}
+
+#ifdef _DEBUG
+	// Returns the statistics collected since the previous call
+	Stats takeStats() noexcept {
+		Stats ret;
+		ret.events = pushCount.exchange(0);
+		ret.totalPushTimeNs = totalPushTimeNs.exchange(0);
+		ret.maxPushTimeNs = maxPushTimeNs.exchange(0);
+		ret.maxQueueTimeMs = stats.maxQueueTimeMs;
+		stats = Stats();
+		return ret;
+	}
+#endif
 private:
-	void queueTask(const T& aItem, MergeTask&& aData) {
-		auto j = tasks.find(aItem);
-		if (j != tasks.end()) {
-			(*j).second.merge(aData);
-			return;
+	struct Event {
+		Event(const T& aItem, MergeTask&& aTask) : item(aItem), task(std::move(aTask)) { }
+
+		T item;
+		MergeTask task;
+		Event* next = nullptr;
+
+#ifdef _DEBUG
+		std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+#endif
+	};
+
+	void push(Event* aEvent) noexcept {
+#ifdef _DEBUG
+		auto start = std::chrono::steady_clock::now();
+#endif
+
+		auto next = head.load(std::memory_order_relaxed);
+		do {
+			aEvent->next = next;
+		} while (!head.compare_exchange_weak(next, aEvent, std::memory_order_release, std::memory_order_relaxed));
+
+#ifdef _DEBUG
+		auto pushTimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		pushCount++;
+		totalPushTimeNs += pushTimeNs;
+
+		auto prevMax = maxPushTimeNs.load(std::memory_order_relaxed);
+		while (prevMax < pushTimeNs && !maxPushTimeNs.compare_exchange_weak(prevMax, pushTimeNs)) {
+			// Retry
+		}
+#endif
+	}
+
+	// The stack contains the newest events first
+	static Event* reverse(Event* aEvents) noexcept {
+		Event* ret = nullptr;
+		while (aEvents) {
+			auto next = aEvents->next;
+			aEvents->next = ret;
+			ret = aEvents;
+			aEvents = next;
 		}
 
-		tasks.emplace(aItem, move(aData));
+		return ret;
 	}
 
-	PropertyIdSet updatedProperties;
-	SharedMutex cs;
-	TaskMap tasks;
+	static void deleteEvents(Event* aEvents) noexcept {
+		while (aEvents) {
+			auto next = aEvents->next;
+			delete aEvents;
+			aEvents = next;
+		}
+	}
+
+	std::atomic<Event*> head { nullptr };
+
+#ifdef _DEBUG
+	std::atomic<uint64_t> pushCount { 0 };
+	std::atomic<uint64_t> totalPushTimeNs { 0 };
+	std::atomic<uint64_t> maxPushTimeNs { 0 };
+
+	// Accessed by the consumer only
+	Stats stats;
+#endif
 };
 
 }
@@ -52,6 +52,8 @@
 #include <websocketpp/config/asio.hpp>
 #include <websocketpp/server.hpp>
 
+#include <web-server/WebSocketDeflate.h>
+
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/algorithm/cxx11/copy_if.hpp>
 
@@ -62,8 +64,8 @@
 namespace webserver {
 	// define types for two different server endpoints, one for each config we are
 	// using
-	typedef websocketpp::server<websocketpp::config::asio> server_plain;
-	typedef websocketpp::server<websocketpp::config::asio_tls> server_tls;
+	typedef websocketpp::server<asio_deflate> server_plain;
+	typedef websocketpp::server<stream_tls_deflate> server_tls;
 	typedef websocketpp::http::status_code::value api_return;
 
 	typedef std::function<void(api_return aStatus, const std::string& aOutput, const std::vector<std::pair<std::string, std::string>>& aHeaders)> HTTPFileCompletionF;
@@ -103,6 +105,10 @@ namespace webserver {
 	class WebSocket;
 	typedef std::shared_ptr<WebSocket> WebSocketPtr;
 
+	// Immutable serialized message that can be queued to any number of sockets
+	class MessageFrame;
+	typedef std::shared_ptr<const MessageFrame> MessageFramePtr;
+
 	class WebServerManager;
 }
 
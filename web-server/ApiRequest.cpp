@@ -27,8 +27,8 @@
 #include <airdcpp/Util.h>
 
 namespace webserver {
-	ApiRequest::ApiRequest(const string& aUrl, const string& aMethod, const json& aBody, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler, json& output_, json& error_) :
-		methodStr(aMethod), session(aSession), requestJson(aBody), path(aUrl), deferredHandler(aDeferredHandler), responseJsonData(output_), responseJsonError(error_)
+	ApiRequest::ApiRequest(const string& aUrl, const string& aMethod, const JsonRange& aBody, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler, json& output_, json& error_) :
+		methodStr(aMethod), session(aSession), requestBodyText(aBody), path(aUrl), deferredHandler(aDeferredHandler), responseJsonData(output_), responseJsonError(error_)
 	{
 
 		if (aUrl.compare(0, 4, "/api") != 0) {
@@ -52,6 +52,22 @@ namespace webserver {
 		validate();
 	}
 
+	void ApiRequest::parseRequestBody() {
+		if (requestBodyParsed) {
+			return;
+		}
+
+		if (!requestBodyText.empty()) {
+			try {
+				requestJson = requestBodyText.parse();
+			} catch (const json::parse_error& e) {
+				throw RequestException(websocketpp::http::status_code::bad_request, "Parsing failed: " + string(e.what()));
+			}
+		}
+
+		requestBodyParsed = true;
+	}
+
 	void ApiRequest::validate() {
 		// Method
 		if (method == METHOD_LAST) {
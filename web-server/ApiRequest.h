@@ -21,6 +21,9 @@
 
 #include "stdinc.h"
 
+#include <web-server/JsonScanner.h>
+#include <web-server/JsonWriter.h>
+
 #include <airdcpp/typedefs.h>
 #include <airdcpp/GetSet.h>
 
@@ -44,8 +47,10 @@ namespace webserver {
 		typedef std::deque<std::string> PathTokenList;
 		typedef std::map<std::string, std::string> NamedParamMap;
 
+		// The body won't be parsed until the request has been routed to a handler
+		// (the body text must remain valid during the lifetime of the request)
 		// Throws on errors
-		ApiRequest(const std::string& aUrl, const std::string& aMethod, const json& aBody, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler, json& output_, json& error_);
+		ApiRequest(const std::string& aUrl, const std::string& aMethod, const JsonRange& aBody, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler, json& output_, json& error_);
 
 		int getApiVersion() const noexcept {
 			return apiVersion;
@@ -84,17 +89,42 @@ namespace webserver {
 		int64_t getSizeParam(const string& aName) const noexcept;
 
 		bool hasRequestBody() const noexcept {
+			if (!requestBodyParsed) {
+				return !requestBodyText.empty() && !requestBodyText.isNull();
+			}
+
 			return !requestJson.is_null();
 		}
 
 		const json& getRequestBody() const noexcept {
+			dcassert(requestBodyParsed);
 			return requestJson;
 		}
 
+		// Parses the request body if it hasn't been parsed yet
+		// Throws RequestException in case of invalid JSON
+		void parseRequestBody();
+
+		// Set a body that has been decoded already (binary socket messages)
+		void setRequestBody(json&& aBody) noexcept {
+			requestJson = std::move(aBody);
+			requestBodyParsed = true;
+		}
+
 		void setResponseBody(const json& aResponse) {
 			responseJsonData = aResponse;
 		}
 
+		// Response data that was written without building a JSON document (synchronous responses only)
+		void setSerializedResponseBody(JsonWriter&& aWriter) noexcept {
+			responseSerializedData = aWriter.release();
+		}
+
+		// Returns the data set with a writer (empty if the response was set as JSON)
+		string& getSerializedResponseBody() noexcept {
+			return responseSerializedData;
+		}
+
 		void setResponseErrorStr(const std::string& aError) {
 			responseJsonError = toResponseErrorStr(aError);
 		}
@@ -133,10 +163,13 @@ namespace webserver {
 
 		RequestMethod method = METHOD_LAST;
 
-		const json requestJson;
+		const JsonRange requestBodyText;
+		json requestJson;
+		bool requestBodyParsed = false;
 
 		json& responseJsonData;
 		json& responseJsonError;
+		string responseSerializedData;
 		ApiDeferredHandler deferredHandler;
 	};
 }
@@ -19,6 +19,7 @@
 #include "stdinc.h"
 #include <web-server/version.h>
 #include <web-server/ApiRouter.h>
+#include <web-server/HttpUtil.h>
 #include <web-server/JsonUtil.h>
 
 #include <web-server/ApiRequest.h>
@@ -35,6 +36,28 @@
 #include <sstream>
 
 namespace webserver {
+	namespace {
+		struct InlineRoute {
+			const char* method;
+
+			// nullptr = any module (the pattern is matched against the end of the path)
+			const char* module;
+
+			// "*" matches any path token
+			StringList pattern;
+		};
+
+		const InlineRoute inlineRoutes[] = {
+			// Event subscriptions
+			{ "POST", nullptr, { "listeners", "*" } },
+			{ "DELETE", nullptr, { "listeners", "*" } },
+
+			{ "POST", "sessions", { "activity" } },
+			{ "GET", "system", { "stats" } },
+			{ "GET", "system", { "away" } },
+		};
+	}
+
 	ApiRouter::ApiRouter() {
 	}
 
@@ -42,22 +65,79 @@ namespace webserver {
 
 	}
 
-	void ApiRouter::handleSocketRequest(const string& aMessage, WebSocketPtr& aSocket, bool aIsSecure) noexcept {
+	bool ApiRouter::isInlineRequest(const string& aMethod, const string& aPath) noexcept {
+		// /api/<version>/<module>/...
+		StringTokenizer<string> tokenizer(aPath, '/');
+		const auto& tokens = tokenizer.getTokens();
+		if (tokens.size() < 4) {
+			return false;
+		}
+
+		const auto& module = tokens[2];
+		for (const auto& route: inlineRoutes) {
+			if (aMethod != route.method || (route.module && module != route.module)) {
+				continue;
+			}
+
+			auto pathTokens = tokens.size() - 3;
+			if (route.module ? pathTokens != route.pattern.size() : pathTokens < route.pattern.size()) {
+				continue;
+			}
+
+			auto matches = std::equal(route.pattern.begin(), route.pattern.end(), tokens.end() - route.pattern.size(), [](const string& aPattern, const string& aToken) {
+				return aPattern == "*" || aPattern == aToken;
+			});
+
+			if (matches) {
+				return true;
+			}
+		}
+
+		return false;
+	}
 
-		dcdebug("Received socket request: %s\n", aMessage.size() > 500 ? (aMessage.substr(0, 500) + "...").c_str() : aMessage.c_str());
+	void ApiRouter::handleSocketRequest(string&& aMessage, bool aIsBinary, const WebSocketPtr& aSocket, bool aIsSecure) noexcept {
+		auto encoding = aIsBinary ? aSocket->getEncoding() : MessageEncoding::TYPE_JSON;
+		if (!aIsBinary) {
+			dcdebug("Received socket request: %s\n", aMessage.size() > 500 ? (aMessage.substr(0, 500) + "...").c_str() : aMessage.c_str());
+		} else {
+			dcdebug("Received socket request (%s, %d bytes)\n", MessageEncoding::toString(encoding).c_str(), static_cast<int>(aMessage.size()));
+		}
 
 		// Parse request
-		websocketpp::http::status_code::value code;
-		int callbackId = -1;
-		string method, path;
-		json data;
+		auto request = std::make_shared<SocketRequest>();
+		request->message = std::move(aMessage);
+		request->isBinary = aIsBinary;
 		try {
-			WebSocket::parseRequest(aMessage, callbackId, method, path, data);
+			if (aIsBinary) {
+				if (!MessageEncoding::isBinary(encoding)) {
+					throw std::invalid_argument("Binary messages can't be used with the JSON encoding");
+				}
+
+				WebSocket::parseRequest(encoding, request->message, request->callbackId, request->method, request->path, request->decodedData);
+			} else {
+				WebSocket::parseRequest(request->message, request->callbackId, request->method, request->path, request->data);
+			}
 		} catch (const std::exception& e) {
-			aSocket->sendApiResponse(nullptr, ApiRequest::toResponseErrorStr("Parsing failed: " + string(e.what())), websocketpp::http::status_code::bad_request, callbackId);
+			aSocket->sendApiResponse(nullptr, ApiRequest::toResponseErrorStr("Parsing failed: " + string(e.what())), websocketpp::http::status_code::bad_request, request->callbackId);
 			return;
 		}
 
+		auto queued = aSocket->dispatchRequest(
+			[this, request, aSocket, aIsSecure] {
+				executeSocketRequest(*request, aSocket, aIsSecure);
+			},
+			isInlineRequest(request->method, aSocket->getConnectUrl() + request->path)
+		);
+
+		if (!queued) {
+			aSocket->sendApiResponse(nullptr, ApiRequest::toResponseErrorStr("Too many pending requests"), websocketpp::http::status_code::service_unavailable, request->callbackId);
+		}
+	}
+
+	void ApiRouter::executeSocketRequest(SocketRequest& aRequest, const WebSocketPtr& aSocket, bool aIsSecure) noexcept {
+		auto callbackId = aRequest.callbackId;
+
 		// Prepare response handlers
 		const auto responseF = [callbackId, aSocket](websocketpp::http::status_code::value aStatus, const json& aResponseJsonData, const json& aResponseErrorJson) {
 			aSocket->sendApiResponse(aResponseJsonData, aResponseErrorJson, aStatus, callbackId);
@@ -75,24 +155,32 @@ namespace webserver {
 		// Route request
 
 		json responseJsonData, responseErrorJson;
-		ApiRequest apiRequest(aSocket->getConnectUrl() + path, method, std::move(data), aSocket->getSession(), deferredF, responseJsonData, responseErrorJson);
-		code = handleRequest(apiRequest, aIsSecure, aSocket, aSocket->getIp());
+		ApiRequest apiRequest(aSocket->getConnectUrl() + aRequest.path, aRequest.method, aRequest.data, aSocket->getSession(), deferredF, responseJsonData, responseErrorJson);
+		if (aRequest.isBinary) {
+			apiRequest.setRequestBody(std::move(aRequest.decodedData));
+		}
+
+		auto code = handleRequest(apiRequest, aIsSecure, aSocket, aSocket->getIp());
 		if (!isDeferred) {
-			responseF(code, responseJsonData, responseErrorJson);
+			const auto& serializedData = apiRequest.getSerializedResponseBody();
+			if (!serializedData.empty() && HttpUtil::isStatusOk(code)) {
+				aSocket->sendApiResponse(serializedData, code, callbackId);
+			} else {
+				responseF(code, responseJsonData, responseErrorJson);
+			}
 		}
 	}
 
 	websocketpp::http::status_code::value ApiRouter::handleHttpRequest(const string& aRequestPath,
-		const websocketpp::http::parser::request& aRequest, json& output_, json& error_,
+		const websocketpp::http::parser::request& aRequest, json& output_, string& serializedOutput_, json& error_,
 		bool aIsSecure, const string& aIp, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler) noexcept 
 	{
 
 		dcdebug("Received HTTP request: %s\n", aRequest.get_body().c_str());
 		try {
-			auto bodyJson = aRequest.get_body().empty() ? json() : json::parse(aRequest.get_body());
-
-			ApiRequest apiRequest(aRequestPath, aRequest.get_method(), std::move(bodyJson), aSession, aDeferredHandler, output_, error_);
+			ApiRequest apiRequest(aRequestPath, aRequest.get_method(), JsonRange(aRequest.get_body()), aSession, aDeferredHandler, output_, error_);
 			const auto status = handleRequest(apiRequest, aIsSecure, nullptr, aIp);
+			serializedOutput_ = std::move(apiRequest.getSerializedResponseBody());
 			return status;
 		} catch (const std::exception& e) {
 			error_ = { 
@@ -146,6 +234,7 @@ namespace webserver {
 	}
 
 	api_return ApiRouter::routeAuthRequest(ApiRequest& aRequest, bool aIsSecure, const WebSocketPtr& aSocket, const string& aIp) {
+		aRequest.parseRequestBody();
 		if (aRequest.getPathTokenAt(0) == "authorize" && aRequest.getMethod() == METHOD_POST) {
 			return SessionApi::handleLogin(aRequest, aIsSecure, aSocket, aIp);
 		} else if (aRequest.getPathTokenAt(0) == "socket" && aRequest.getMethod() == METHOD_POST) {
@@ -21,6 +21,8 @@
 
 #include "stdinc.h"
 
+#include <web-server/JsonScanner.h>
+
 #include <airdcpp/typedefs.h>
 
 namespace webserver {
@@ -29,10 +31,32 @@ namespace webserver {
 		ApiRouter();
 		~ApiRouter();
 
-		void handleSocketRequest(const std::string& aMessage, WebSocketPtr& aSocket, bool aIsSecure) noexcept;
+		// The request is parsed in the calling (IO) thread and handled in the request pool (see WebSocket::dispatchRequest)
+		// Text messages are always JSON, binary messages are decoded with the encoding of the socket
+		void handleSocketRequest(string&& aMessage, bool aIsBinary, const WebSocketPtr& aSocket, bool aIsSecure) noexcept;
+
+		// Handles the request in the calling thread
 		api_return handleHttpRequest(const std::string& aRequestPath, const websocketpp::http::parser::request& aRequest,
-			json& output_, json& error_, bool aIsSecure, const string& aIp, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler) noexcept;
+			json& output_, string& serializedOutput_, json& error_, bool aIsSecure, const string& aIp, const SessionPtr& aSession, const ApiDeferredHandler& aDeferredHandler) noexcept;
+
+		// Returns true for requests that are cheap to handle and never block so that they can be handled in the IO threads
+		static bool isInlineRequest(const string& aMethod, const string& aPath) noexcept;
 	private:
+		struct SocketRequest {
+			string message;
+			int callbackId = -1;
+			string method, path;
+
+			// Refers to the message
+			JsonRange data;
+
+			// Binary requests are decoded when they are parsed
+			json decodedData;
+			bool isBinary = false;
+		};
+
+		void executeSocketRequest(SocketRequest& aRequest, const WebSocketPtr& aSocket, bool aIsSecure) noexcept;
+
 		api_return handleRequest(ApiRequest& aRequest, bool aIsSecure, const WebSocketPtr& aSocket, const string& aIp) noexcept;
 
 		api_return routeAuthRequest(ApiRequest& aRequest, bool aIsSecure, const WebSocketPtr& aSocket, const string& aIp);
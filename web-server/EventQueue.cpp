@@ -0,0 +1,295 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/EventQueue.h>
+#include <web-server/JsonScanner.h>
+#include <web-server/JsonWriter.h>
+#include <web-server/MessageEncoding.h>
+
+#include <airdcpp/Util.h>
+
+
+namespace webserver {
+	namespace {
+		// Event names are compared in their serialized (quoted) form
+		bool endsWith(std::string_view aEvent, std::string_view aSuffix) noexcept {
+			return aEvent.size() >= aSuffix.size() && aEvent.compare(aEvent.size() - aSuffix.size(), aSuffix.size(), aSuffix) == 0;
+		}
+	}
+
+	void EventQueue::add(const MessageFramePtr& aMessage, bool aSupersedeState) noexcept {
+		EventFields fields;
+		if (parseEvent(aMessage->getText(), fields)) {
+			auto key = getEntityKey(fields);
+			if (key.empty() && aSupersedeState && isStateEvent(fields.event)) {
+				key = getStateKey(fields);
+			}
+
+			if (!key.empty()) {
+				if (mergeQueued(key, aMessage, fields)) {
+					return;
+				}
+			} else if (endsWith(fields.event, "_removed\"")) {
+				// The entity may be added again
+				entityUpdates.clear();
+			}
+		}
+
+		bytes += aMessage->getText().size();
+		events.push_back(aMessage);
+	}
+
+	bool EventQueue::mergeQueued(const string& aKey, const MessageFramePtr& aMessage, const EventFields& aFields) noexcept {
+		auto i = entityUpdates.find(aKey);
+		if (i == entityUpdates.end()) {
+			entityUpdates.emplace(aKey, events.size());
+			return false;
+		}
+
+		auto& queued = events[i->second];
+
+		EventFields queuedFields;
+		if (!parseEvent(queued->getText(), queuedFields)) {
+			return false;
+		}
+
+		try {
+			auto merged = std::make_shared<const MessageFrame>(mergeUpdate(queued->getText(), queuedFields, aMessage->getText(), aFields));
+
+			bytes = bytes - queued->getText().size() + merged->getText().size();
+			queued = std::move(merged);
+		} catch (const std::exception&) {
+			// Queue as a separate event
+			return false;
+		}
+
+		if (isStateEvent(aFields.event)) {
+			supersededCount++;
+		} else {
+			mergedCount++;
+		}
+
+		return true;
+	}
+
+	vector<MessageFramePtr> EventQueue::take() noexcept {
+		vector<MessageFramePtr> ret;
+		ret.swap(events);
+
+		entityUpdates.clear();
+		bytes = 0;
+		return ret;
+	}
+
+	bool EventQueue::isStateEvent(std::string_view aEvent) noexcept {
+		return endsWith(aEvent, "_view_updated\"") || aEvent == "\"transfer_statistics\"" || aEvent == "\"hub_counts_updated\"" || aEvent == "\"hash_statistics\"";
+	}
+
+	bool EventQueue::parseEvent(std::string_view aMessage, EventFields& fields_) noexcept {
+		try {
+			JsonScanner::forEachField(aMessage, [&](const string& aKey, const JsonRange& aValue) {
+				if (aKey == "event") {
+					fields_.event = aValue.view();
+				} else if (aKey == "id") {
+					fields_.id = aValue.view();
+				} else if (aKey == "data") {
+					fields_.data = aValue.view();
+				}
+			});
+		} catch (const json::parse_error&) {
+			return false;
+		}
+
+		return !fields_.event.empty();
+	}
+
+	string EventQueue::getEntityKey(const EventFields& aFields) noexcept {
+		if (!endsWith(aFields.event, "_updated\"") || aFields.data.empty() || aFields.data.front() != '{') {
+			return Util::emptyString;
+		}
+
+		// Only the updates of individual items can be merged (list view updates contain item arrays instead)
+		std::string_view dataId;
+		try {
+			JsonScanner::forEachField(aFields.data, [&](const string& aKey, const JsonRange& aValue) {
+				if (aKey == "id") {
+					dataId = aValue.view();
+				}
+			});
+		} catch (const json::parse_error&) {
+			return Util::emptyString;
+		}
+
+		if (dataId.empty()) {
+			return Util::emptyString;
+		}
+
+		string key;
+		key.reserve(aFields.event.size() + aFields.id.size() + dataId.size() + 2);
+
+		key += aFields.event;
+		key += '\n';
+		key += aFields.id;
+		key += '\n';
+		key += dataId;
+		return key;
+	}
+
+	string EventQueue::getStateKey(const EventFields& aFields) noexcept {
+		if (aFields.data.empty() || aFields.data.front() != '{') {
+			return Util::emptyString;
+		}
+
+		string key;
+		key.reserve(aFields.event.size() + aFields.id.size() + 1);
+
+		key += aFields.event;
+		key += '\n';
+		key += aFields.id;
+		return key;
+	}
+
+	string EventQueue::mergeUpdate(std::string_view aOldMessage, const EventFields& aOldFields, std::string_view aNewMessage, const EventFields& aNewFields) {
+		// List view updates contain changes of the visible items and the viewport position
+		auto isView = endsWith(aNewFields.event, "_view_updated\"");
+
+		StringMap oldValues;
+		JsonScanner::forEachField(aOldFields.data, [&](const string& aKey, const JsonRange& aValue) {
+			oldValues.emplace(aKey, string(aValue.view()));
+		});
+
+		JsonWriter data(aOldFields.data.size() + aNewFields.data.size());
+		data.startObject();
+
+		// Latest values
+		StringSet newProperties;
+		JsonScanner::forEachField(aNewFields.data, [&](const string& aKey, const JsonRange& aValue) {
+			data.writeKey(aKey);
+			newProperties.insert(aKey);
+
+			auto old = oldValues.find(aKey);
+			if (isView && old != oldValues.end()) {
+				if (aKey == "items") {
+					data.writeRaw(mergeViewItems(old->second, aValue.view()));
+					return;
+				}
+
+				if (aKey == "range_offset") {
+					// Relative to the range of the previous update
+					data.writeInteger(json::parse(old->second).get<int64_t>() + aValue.parse().get<int64_t>());
+					return;
+				}
+			}
+
+			data.writeRaw(aValue.view());
+		});
+
+		// Properties that haven't been updated since
+		JsonScanner::forEachField(aOldFields.data, [&](const string& aKey, const JsonRange& aValue) {
+			if (newProperties.find(aKey) == newProperties.end()) {
+				data.writeKey(aKey);
+				data.writeRaw(aValue.view());
+			}
+		});
+
+		data.endObject();
+
+		// Use the envelope of the new message
+		auto dataPos = static_cast<size_t>(aNewFields.data.data() - aNewMessage.data());
+
+		string ret;
+		ret.reserve(aNewMessage.size() + data.size());
+
+		ret += aNewMessage.substr(0, dataPos);
+		ret += data.str();
+		ret += aNewMessage.substr(dataPos + aNewFields.data.size());
+		return ret;
+	}
+
+	string EventQueue::mergeViewItems(std::string_view aOldItems, std::string_view aNewItems) {
+		// Property values of the old items by item ID
+		StringMap oldProperties;
+		JsonScanner::forEachElement(aOldItems, [&](const JsonRange& aItem) {
+			string id, properties;
+			JsonScanner::forEachField(aItem.view(), [&](const string& aKey, const JsonRange& aValue) {
+				if (aKey == "id") {
+					id = string(aValue.view());
+				} else if (aKey == "properties") {
+					properties = string(aValue.view());
+				}
+			});
+
+			if (!properties.empty()) {
+				oldProperties.emplace(std::move(id), std::move(properties));
+			}
+		});
+
+		// Use the item order of the latest update
+		JsonWriter items(aOldItems.size() + aNewItems.size());
+		items.startArray();
+		JsonScanner::forEachElement(aNewItems, [&](const JsonRange& aItem) {
+			std::string_view id, properties;
+			JsonScanner::forEachField(aItem.view(), [&](const string& aKey, const JsonRange& aValue) {
+				if (aKey == "id") {
+					id = aValue.view();
+				} else if (aKey == "properties") {
+					properties = aValue.view();
+				}
+			});
+
+			auto old = oldProperties.find(string(id));
+			if (id.empty() || old == oldProperties.end()) {
+				items.writeRaw(aItem.view());
+				return;
+			}
+
+			items.startObject();
+			items.writeKey("id");
+			items.writeRaw(id);
+			items.writeKey("properties");
+			if (properties.empty()) {
+				items.writeRaw(old->second);
+			} else {
+				items.startObject();
+
+				StringSet newProperties;
+				JsonScanner::forEachField(properties, [&](const string& aKey, const JsonRange& aValue) {
+					items.writeKey(aKey);
+					items.writeRaw(aValue.view());
+					newProperties.insert(aKey);
+				});
+
+				JsonScanner::forEachField(old->second, [&](const string& aKey, const JsonRange& aValue) {
+					if (newProperties.find(aKey) == newProperties.end()) {
+						items.writeKey(aKey);
+						items.writeRaw(aValue.view());
+					}
+				});
+
+				items.endObject();
+			}
+
+			items.endObject();
+		});
+
+		items.endArray();
+		return items.release();
+	}
+}
@@ -0,0 +1,116 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_EVENT_QUEUE_H
+#define DCPLUSPLUS_DCPP_EVENT_QUEUE_H
+
+#include "stdinc.h"
+
+#include <string_view>
+
+
+namespace webserver {
+	// Outgoing events of a socket that are sent together in a single JSON array
+	//
+	// Updates of the same entity (*_updated events with identical event name, envelope ID and data ID) are merged
+	// while they are waiting in the queue so that only the latest value of each property gets sent. The merged event
+	// keeps the position of the first queued update. A queued *_removed event prevents merging later updates into
+	// events that were queued before it.
+	//
+	// State events (list view updates and periodic statistics) can be superseded as well when the socket can't keep up
+	// with the events: a newer event with the same name and envelope ID is merged into the queued one. The view items
+	// are merged by item ID so that property changes of the superseded update won't get lost.
+	//
+	// The queue isn't thread safe.
+	class EventQueue {
+	public:
+		// The queue should be flushed immediately after reaching either of these (unless the socket is congested)
+		static const size_t MAX_EVENTS = 1000;
+		static const size_t MAX_BYTES = 256 * 1024;
+
+		// Use aSupersedeState to merge state events into the queued event of the same type
+		void add(const MessageFramePtr& aMessage, bool aSupersedeState = false) noexcept;
+
+		// Returns the queued events and clears the queue
+		vector<MessageFramePtr> take() noexcept;
+
+		bool empty() const noexcept {
+			return events.empty();
+		}
+
+		// Serialized size of the queued events
+		size_t getBytes() const noexcept {
+			return bytes;
+		}
+
+		bool full() const noexcept {
+			return events.size() >= MAX_EVENTS || bytes >= MAX_BYTES;
+		}
+
+		size_t size() const noexcept {
+			return events.size();
+		}
+
+		// Number of events that have been merged into a queued update
+		uint64_t getMergedCount() const noexcept {
+			return mergedCount;
+		}
+
+		// Number of state events that have been merged into a queued event
+		uint64_t getSupersededCount() const noexcept {
+			return supersededCount;
+		}
+
+		// List view updates and periodic statistics
+		static bool isStateEvent(std::string_view aEvent) noexcept;
+	private:
+		struct EventFields {
+			// Unparsed values
+			std::string_view event;
+			std::string_view id;
+			std::string_view data;
+		};
+
+		// Returns false if the message isn't an event object
+		static bool parseEvent(std::string_view aMessage, EventFields& fields_) noexcept;
+
+		// Returns an empty string if the event can't be merged
+		static string getEntityKey(const EventFields& aFields) noexcept;
+		static string getStateKey(const EventFields& aFields) noexcept;
+
+		// Merge the event into a queued event with the same key
+		// Returns false if there is no queued event or the events couldn't be merged
+		bool mergeQueued(const string& aKey, const MessageFramePtr& aMessage, const EventFields& aFields) noexcept;
+
+		// Returns the new message with the properties of the old event data that are missing from it
+		static string mergeUpdate(std::string_view aOldMessage, const EventFields& aOldFields, std::string_view aNewMessage, const EventFields& aNewFields);
+
+		// Returns the new view items with the properties of the old items that are missing from them
+		static string mergeViewItems(std::string_view aOldItems, std::string_view aNewItems);
+
+		vector<MessageFramePtr> events;
+		size_t bytes = 0;
+
+		// Queue positions of mergeable updates
+		std::unordered_map<string, size_t> entityUpdates;
+		uint64_t mergedCount = 0;
+		uint64_t supersededCount = 0;
+	};
+}
+
+#endif
@@ -80,7 +80,7 @@ namespace webserver {
 			dcassert(extension[0] != '.');
 
 			// We have compressed versions only for JS files
-			if (extension == "js" && aRequest.get_header("Accept-Encoding").find("gzip") != string::npos) {
+			if (extension == "js" && HttpUtil::acceptsEncoding(aRequest, "gzip")) {
 				request += ".gz";
 				headers_.emplace_back("Content-Encoding", "gzip");
 			}
@@ -0,0 +1,450 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/HttpConnection.h>
+
+#include <airdcpp/Util.h>
+
+#define HANDSHAKE_PEEK_RETRY 10 // milliseconds
+
+
+namespace webserver {
+	template<class StreamT>
+	HttpConnection<StreamT>::HttpConnection(Socket&& aSocket, const context_ptr& aTlsContext, boost::asio::io_service& aIos, const HttpConnectionLimits& aLimits, const RequestHandler& aRequestHandler, const UpgradeHandler& aUpgradeHandler) :
+		tlsContext(aTlsContext), stream(createStream(std::move(aSocket), aTlsContext)), strand(aIos), timer(aIos), retryTimer(aIos),
+		limits(aLimits), requestHandler(aRequestHandler), upgradeHandler(aUpgradeHandler) {
+
+	}
+
+	template<class StreamT>
+	StreamT HttpConnection<StreamT>::createStream(Socket&& aSocket, const context_ptr& aTlsContext) {
+		if constexpr (secure) {
+			dcassert(aTlsContext);
+			return StreamT(std::move(aSocket), *aTlsContext);
+		} else {
+			return StreamT(std::move(aSocket));
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::start() noexcept {
+		boost::system::error_code ec;
+		auto endpoint = stream.lowest_layer().remote_endpoint(ec);
+		if (ec) {
+			closeUnsafe();
+			return;
+		}
+
+		ip = endpoint.address().to_string();
+
+		setTimeout(limits.idleTimeout);
+		if constexpr (secure) {
+			stream.async_handshake(
+				boost::asio::ssl::stream_base::server,
+				strand.wrap(std::bind(&HttpConnection::onTlsHandshake, this->shared_from_this(), std::placeholders::_1))
+			);
+		} else {
+			waitHandshake();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::close() noexcept {
+		strand.post(std::bind(&HttpConnection::closeGracefullyUnsafe, this->shared_from_this()));
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::closeGracefullyUnsafe() noexcept {
+		if (writing) {
+			closeAfterWrite = true;
+			return;
+		}
+
+		closeUnsafe();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::closeUnsafe() noexcept {
+		if (closed) {
+			return;
+		}
+
+		closed = true;
+
+		boost::system::error_code ec;
+		timer.cancel(ec);
+		retryTimer.cancel(ec);
+
+		auto& socket = stream.lowest_layer();
+		socket.shutdown(boost::asio::socket_base::shutdown_both, ec);
+		socket.close(ec);
+
+		if (tunnel.closeF) {
+			tunnel.closeF();
+
+			// Release the websocketpp connection
+			tunnel = Tunnel();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onTlsHandshake(const boost::system::error_code& aError) noexcept {
+		if (aError || closed) {
+			closeUnsafe();
+			return;
+		}
+
+		readRequest();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::waitHandshake() noexcept {
+		if constexpr (!secure) {
+			if (closed) {
+				return;
+			}
+
+			stream.async_wait(boost::asio::socket_base::wait_read, strand.wrap(std::bind(&HttpConnection::onHandshakeReadable, this->shared_from_this(), std::placeholders::_1)));
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onHandshakeReadable(const boost::system::error_code& aError) noexcept {
+		if constexpr (!secure) {
+			if (aError || closed) {
+				closeUnsafe();
+				return;
+			}
+
+			boost::system::error_code ec;
+			auto bytes = stream.receive(boost::asio::buffer(readBuffer), boost::asio::socket_base::message_peek, ec);
+			if (ec || bytes == 0) {
+				closeUnsafe();
+				return;
+			}
+
+			string head(readBuffer.data(), bytes);
+			if (head.find("\r\n\r\n") == string::npos && bytes < readBuffer.size()) {
+				// Headers haven't been fully received yet
+				// Reading for the socket would return immediately as the peeked data is still there
+				retryTimer.expires_from_now(boost::posix_time::milliseconds(HANDSHAKE_PEEK_RETRY));
+				retryTimer.async_wait(strand.wrap([this, self = this->shared_from_this()](const boost::system::error_code& aRetryError) {
+					if (!aRetryError) {
+						waitHandshake();
+					}
+				}));
+				return;
+			}
+
+			auto isWebSocket = false;
+			try {
+				websocketpp::http::parser::request handshake;
+				handshake.consume(head.data(), head.size());
+				isWebSocket = websocketpp::processor::is_websocket_handshake(handshake);
+			} catch (const websocketpp::http::exception&) {
+				// The error will be reported when the request is read
+			}
+
+			if (isWebSocket) {
+				// Websocketpp takes care of the socket from now on
+				upgradeHandler(this->shared_from_this());
+				return;
+			}
+
+			readRequest();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::releaseSocket(Socket& socket_) noexcept {
+		if constexpr (!secure) {
+			closed = true;
+
+			boost::system::error_code ec;
+			timer.cancel(ec);
+
+			socket_ = std::move(stream);
+		} else {
+			dcassert(0);
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::readRequest() noexcept {
+		if (closed) {
+			return;
+		}
+
+		setTimeout(limits.idleTimeout);
+		stream.async_read_some(
+			boost::asio::buffer(readBuffer),
+			strand.wrap(std::bind(&HttpConnection::onRead, this->shared_from_this(), std::placeholders::_1, std::placeholders::_2))
+		);
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onRead(const boost::system::error_code& aError, size_t aBytes) noexcept {
+		if (aError || closed) {
+			closeUnsafe();
+			return;
+		}
+
+		if (secure && requestCount == 0) {
+			// Passed to the tunnel if this is a WebSocket handshake
+			handshakeData.append(readBuffer.data(), aBytes);
+		}
+
+		buffer.append(readBuffer.data(), aBytes);
+		processBuffer();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::processBuffer() noexcept {
+		try {
+			auto consumed = request.consume(buffer.data(), buffer.size());
+			buffer.erase(0, consumed);
+		} catch (const websocketpp::http::exception& e) {
+			sendError(e.m_error_code, e.m_error_msg);
+			return;
+		}
+
+		if (!request.ready()) {
+			readRequest();
+			return;
+		}
+
+		handleRequest();
+	}
+
+	template<class StreamT>
+	bool HttpConnection<StreamT>::isKeepAliveRequest() const noexcept {
+		const auto& connection = request.get_header("Connection");
+		if (request.get_version() == "HTTP/1.0") {
+			return websocketpp::utility::ci_find_substr(connection, "keep-alive", 10) != connection.end();
+		}
+
+		return websocketpp::utility::ci_find_substr(connection, "close", 5) == connection.end();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::handleRequest() noexcept {
+		boost::system::error_code ec;
+		timer.cancel(ec);
+
+		requestCount++;
+		keepAlive = requestCount < limits.maxRequests && isKeepAliveRequest();
+
+		if (websocketpp::processor::is_websocket_handshake(request)) {
+			if (secure && requestCount == 1) {
+				upgradeHandler(this->shared_from_this());
+				return;
+			}
+
+			// Upgrades are only accepted for the first request of the connection
+			sendError(websocketpp::http::status_code::bad_request, "WebSocket handshake must be the first request of the connection");
+			return;
+		}
+
+		handshakeData.clear();
+
+		deferred = false;
+		requestHandler(this->shared_from_this());
+
+		if (!deferred) {
+			writeResponse();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::startTunnel(Tunnel&& aTunnel) noexcept {
+		dcassert(secure && requestCount == 1);
+
+		tunnel = std::move(aTunnel);
+		buffer.clear();
+
+		setTimeout(limits.tunnelTimeout);
+
+		auto data = std::move(handshakeData);
+		tunnel.dataF(data.data(), data.size());
+
+		readTunnel();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::readTunnel() noexcept {
+		if (closed) {
+			return;
+		}
+
+		stream.async_read_some(
+			boost::asio::buffer(readBuffer),
+			strand.wrap(std::bind(&HttpConnection::onTunnelRead, this->shared_from_this(), std::placeholders::_1, std::placeholders::_2))
+		);
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onTunnelRead(const boost::system::error_code& aError, size_t aBytes) noexcept {
+		if (aError || closed) {
+			closeUnsafe();
+			return;
+		}
+
+		// Clients reply to the pings so a silent connection is dead
+		setTimeout(limits.tunnelTimeout);
+
+		tunnel.dataF(readBuffer.data(), aBytes);
+		readTunnel();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::write(string&& aData) noexcept {
+		bufferedAmount += aData.size();
+		strand.post([this, self = this->shared_from_this(), data = std::move(aData)]() mutable {
+			if (closed) {
+				return;
+			}
+
+			tunnelQueue.push_back(std::move(data));
+			if (!writing) {
+				writeTunnel();
+			}
+		});
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::writeTunnel() noexcept {
+		responseData.clear();
+		for (const auto& data: tunnelQueue) {
+			responseData += data;
+		}
+
+		tunnelQueue.clear();
+
+		writing = true;
+		boost::asio::async_write(
+			stream,
+			boost::asio::buffer(responseData),
+			strand.wrap(std::bind(&HttpConnection::onTunnelWrite, this->shared_from_this(), std::placeholders::_1))
+		);
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onTunnelWrite(const boost::system::error_code& aError) noexcept {
+		writing = false;
+		bufferedAmount -= responseData.size();
+
+		if (aError) {
+			closeUnsafe();
+			return;
+		}
+
+		if (!tunnelQueue.empty() && !closed) {
+			writeTunnel();
+		} else if (closeAfterWrite) {
+			closeUnsafe();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::send_http_response() noexcept {
+		strand.post(std::bind(&HttpConnection::writeResponse, this->shared_from_this()));
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::sendError(websocketpp::http::status_code::value aCode, const string& aMessage) noexcept {
+		keepAlive = false;
+
+		response = websocketpp::http::parser::response();
+		response.set_status(aCode);
+		response.set_body(aMessage);
+		writeResponse();
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::writeResponse() noexcept {
+		if (closed) {
+			return;
+		}
+
+		response.set_version("HTTP/1.1");
+		if (response.get_body().empty()) {
+			response.replace_header("Content-Length", "0");
+		}
+
+		if (keepAlive) {
+			response.replace_header("Connection", "keep-alive");
+			response.replace_header("Keep-Alive", "timeout=" + Util::toString(limits.idleTimeout) + ", max=" + Util::toString(limits.maxRequests - requestCount));
+		} else {
+			response.replace_header("Connection", "close");
+		}
+
+		responseData = response.raw();
+
+		writing = true;
+		boost::asio::async_write(
+			stream,
+			boost::asio::buffer(responseData),
+			strand.wrap(std::bind(&HttpConnection::onWrite, this->shared_from_this(), std::placeholders::_1))
+		);
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onWrite(const boost::system::error_code& aError) noexcept {
+		writing = false;
+		if (aError || !keepAlive || closeAfterWrite) {
+			closeUnsafe();
+			return;
+		}
+
+		request = websocketpp::http::parser::request();
+		response = websocketpp::http::parser::response();
+		responseData.clear();
+
+		if (!buffer.empty()) {
+			// Pipelined request
+			processBuffer();
+		} else {
+			readRequest();
+		}
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::setTimeout(time_t aSeconds) noexcept {
+		timer.expires_from_now(boost::posix_time::seconds(static_cast<long>(aSeconds)));
+		timer.async_wait(strand.wrap(std::bind(&HttpConnection::onTimeout, this->shared_from_this(), std::placeholders::_1)));
+	}
+
+	template<class StreamT>
+	void HttpConnection<StreamT>::onTimeout(const boost::system::error_code& aError) noexcept {
+		if (aError == boost::asio::error::operation_aborted) {
+			return;
+		}
+
+		// The timer may have been reset after the handler was queued
+		if (timer.expires_at() > boost::asio::deadline_timer::traits_type::now()) {
+			return;
+		}
+
+		closeUnsafe();
+	}
+
+	template class HttpConnection<HttpPlainStream>;
+	template class HttpConnection<HttpTlsStream>;
+}
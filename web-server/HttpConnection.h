@@ -0,0 +1,233 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_HTTP_CONNECTION_H
+#define DCPLUSPLUS_DCPP_HTTP_CONNECTION_H
+
+#include "stdinc.h"
+
+#include <atomic>
+#include <deque>
+
+
+namespace webserver {
+	// type of the ssl context pointer is long so alias it
+	typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
+
+	typedef boost::asio::ip::tcp::socket HttpPlainStream;
+	typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> HttpTlsStream;
+
+	struct HttpConnectionLimits {
+		// Time to wait for the next request (seconds)
+		time_t idleTimeout;
+
+		// Number of requests after which the connection is closed
+		size_t maxRequests;
+
+		// Time without any received data after which an upgraded TLS connection is closed (seconds)
+		time_t tunnelTimeout;
+	};
+
+	// Persistent HTTP/1.1 connection
+	//
+	// Websocketpp closes HTTP connections after each response, which makes every request pay for a new TCP connection
+	// (and a new TLS handshake). Connections are accepted by HttpListener instead and the requests are read here until
+	// the connection becomes idle, the request limit is reached or the client asks the connection to be closed.
+	// Pipelined requests are handled in order.
+	//
+	// If the first request of a plain connection is a WebSocket handshake, the socket is handed over to websocketpp
+	// without consuming any data. Decrypted data can't be given back to a TLS stream, so upgraded TLS connections
+	// stay here and pass the data between the stream and the websocketpp connection (see Tunnel).
+	template<class StreamT>
+	class HttpConnection : public std::enable_shared_from_this<HttpConnection<StreamT>> {
+	public:
+		typedef std::shared_ptr<HttpConnection<StreamT>> Ptr;
+		typedef boost::asio::ip::tcp::socket Socket;
+
+		static constexpr bool secure = std::is_same<StreamT, HttpTlsStream>::value;
+
+		typedef std::function<void(const Ptr& aConnection)> RequestHandler;
+
+		// Called when the first request is a WebSocket handshake
+		// The handler must take the socket (plain connections) or start a tunnel (TLS connections)
+		typedef std::function<void(const Ptr& aConnection)> UpgradeHandler;
+
+		// Receiver of the data of an upgraded TLS connection (the functions are called from the connection strand)
+		struct Tunnel {
+			std::function<void(const char* aData, size_t aLen)> dataF;
+
+			// The connection was closed
+			std::function<void()> closeF;
+		};
+
+		// The TLS context is ignored for plain connections
+		HttpConnection(Socket&& aSocket, const context_ptr& aTlsContext, boost::asio::io_service& aIos, const HttpConnectionLimits& aLimits, const RequestHandler& aRequestHandler, const UpgradeHandler& aUpgradeHandler);
+
+		void start() noexcept;
+
+		// May be called from any thread
+		// Data that is being written is sent before closing the connection
+		void close() noexcept;
+
+		const string& getIp() const noexcept {
+			return ip;
+		}
+
+		// Plain connections only (call from the upgrade handler)
+		// Moves the socket with the unread handshake to socket_
+		void releaseSocket(Socket& socket_) noexcept;
+
+		// TLS connections only (call from the upgrade handler)
+		// Passes the received data to the tunnel, starting from the handshake request
+		void startTunnel(Tunnel&& aTunnel) noexcept;
+
+		// Writes data of an upgraded TLS connection (may be called from any thread)
+		void write(string&& aData) noexcept;
+
+		// Data of an upgraded TLS connection that hasn't been written yet
+		size_t getBufferedAmount() const noexcept {
+			return bufferedAmount;
+		}
+
+		// The following methods have the same signatures as in websocketpp::connection
+		// so that the same request handler can be used with both connection types
+
+		const websocketpp::http::parser::request& get_request() const noexcept {
+			return request;
+		}
+
+		const string& get_resource() const noexcept {
+			return request.get_uri();
+		}
+
+		void set_status(websocketpp::http::status_code::value aCode) {
+			response.set_status(aCode);
+		}
+
+		void set_status(websocketpp::http::status_code::value aCode, const string& aMessage) {
+			response.set_status(aCode, aMessage);
+		}
+
+		void set_body(const string& aBody) {
+			response.set_body(aBody);
+		}
+
+		void append_header(const string& aKey, const string& aValue) {
+			response.append_header(aKey, aValue);
+		}
+
+		// The response will be sent when send_http_response is called (from any thread)
+		websocketpp::lib::error_code defer_http_response() noexcept {
+			deferred = true;
+			return websocketpp::lib::error_code();
+		}
+
+		void send_http_response() noexcept;
+
+		HttpConnection(HttpConnection&) = delete;
+		HttpConnection& operator=(HttpConnection&) = delete;
+	private:
+		static StreamT createStream(Socket&& aSocket, const context_ptr& aTlsContext);
+
+		void onTlsHandshake(const boost::system::error_code& aError) noexcept;
+
+		// Wait until the headers of the first request have been received and check whether it's a WebSocket handshake
+		// The data is only peeked so that it's still available for websocketpp if the socket is upgraded (plain connections)
+		void waitHandshake() noexcept;
+		void onHandshakeReadable(const boost::system::error_code& aError) noexcept;
+
+		void readRequest() noexcept;
+		void onRead(const boost::system::error_code& aError, size_t aBytes) noexcept;
+
+		// Parse the buffered data and handle the request if it's complete (otherwise continue reading)
+		void processBuffer() noexcept;
+		void handleRequest() noexcept;
+
+		void writeResponse() noexcept;
+		void onWrite(const boost::system::error_code& aError) noexcept;
+
+		void sendError(websocketpp::http::status_code::value aCode, const string& aMessage) noexcept;
+
+		void readTunnel() noexcept;
+		void onTunnelRead(const boost::system::error_code& aError, size_t aBytes) noexcept;
+
+		// Write all queued tunnel data
+		void writeTunnel() noexcept;
+		void onTunnelWrite(const boost::system::error_code& aError) noexcept;
+
+		void setTimeout(time_t aSeconds) noexcept;
+		void onTimeout(const boost::system::error_code& aError) noexcept;
+
+		bool isKeepAliveRequest() const noexcept;
+		void closeUnsafe() noexcept;
+
+		// Close after the pending write has completed
+		void closeGracefullyUnsafe() noexcept;
+
+		// Keeps the context alive for the stream
+		const context_ptr tlsContext;
+
+		StreamT stream;
+		boost::asio::io_service::strand strand;
+
+		// Idle timeout
+		boost::asio::deadline_timer timer;
+
+		// Handshake peek retries
+		boost::asio::deadline_timer retryTimer;
+
+		const HttpConnectionLimits limits;
+		const RequestHandler requestHandler;
+		const UpgradeHandler upgradeHandler;
+
+		string ip;
+
+		// Received data that hasn't been parsed yet (pipelined requests)
+		string buffer;
+		std::array<char, 8192> readBuffer;
+
+		// All data received before the first request was handled (TLS connections)
+		string handshakeData;
+
+		websocketpp::http::parser::request request;
+		websocketpp::http::parser::response response;
+
+		// Response or tunnel data that is being written
+		string responseData;
+
+		Tunnel tunnel;
+		std::deque<string> tunnelQueue;
+		std::atomic<size_t> bufferedAmount { 0 };
+
+		size_t requestCount = 0;
+		bool keepAlive = true;
+		// May be set by request handlers in other threads
+		std::atomic<bool> deferred { false };
+		bool writing = false;
+		bool closeAfterWrite = false;
+		bool closed = false;
+	};
+
+	typedef HttpConnection<HttpPlainStream> HttpPlainConnection;
+	typedef HttpConnection<HttpTlsStream> HttpTlsConnection;
+
+	typedef HttpPlainConnection::Ptr HttpPlainConnectionPtr;
+	typedef HttpTlsConnection::Ptr HttpTlsConnectionPtr;
+}
+
+#endif
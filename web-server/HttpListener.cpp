@@ -0,0 +1,136 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/HttpListener.h>
+
+
+namespace webserver {
+	template<class StreamT>
+	HttpListener<StreamT>::HttpListener(boost::asio::io_service& aIos, const HttpConnectionLimits& aLimits, const typename ConnectionType::RequestHandler& aRequestHandler, const typename ConnectionType::UpgradeHandler& aUpgradeHandler, const TlsContextF& aTlsContextF) :
+		ios(aIos), acceptor(aIos), socket(aIos), limits(aLimits), requestHandler(aRequestHandler), upgradeHandler(aUpgradeHandler), tlsContextF(aTlsContextF) {
+
+		dcassert(!ConnectionType::secure || tlsContextF);
+	}
+
+	template<class StreamT>
+	HttpListener<StreamT>::~HttpListener() {
+		stop();
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::listen(const string& aBindAddress, const string& aPort) {
+		boost::asio::ip::tcp::resolver resolver(ios);
+		boost::asio::ip::tcp::resolver::query query(aBindAddress, aPort);
+
+		auto iter = resolver.resolve(query);
+		listen(iter->endpoint());
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::listen(const boost::asio::ip::tcp& aProtocol, uint16_t aPort) {
+		listen(boost::asio::ip::tcp::endpoint(aProtocol, aPort));
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::listen(const boost::asio::ip::tcp::endpoint& aEndpoint) {
+		Lock l(cs);
+		dcassert(!listening);
+
+		acceptor.open(aEndpoint.protocol());
+		try {
+			acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+			acceptor.bind(aEndpoint);
+
+			// Workaround for https://github.com/zaphoyd/websocketpp/issues/549
+			acceptor.listen(boost::asio::socket_base::max_connections);
+		} catch (...) {
+			boost::system::error_code ec;
+			acceptor.close(ec);
+			throw;
+		}
+
+		listening = true;
+		accept();
+	}
+
+	template<class StreamT>
+	bool HttpListener<StreamT>::isListening() const noexcept {
+		Lock l(cs);
+		return listening;
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::stop() noexcept {
+		vector<std::weak_ptr<ConnectionType>> toClose;
+
+		{
+			Lock l(cs);
+			if (listening) {
+				boost::system::error_code ec;
+				acceptor.close(ec);
+				listening = false;
+			}
+
+			toClose.swap(connections);
+		}
+
+		for (const auto& c : toClose) {
+			auto con = c.lock();
+			if (con) {
+				con->close();
+			}
+		}
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::accept() noexcept {
+		acceptor.async_accept(socket, std::bind(&HttpListener::onAccept, this, std::placeholders::_1));
+	}
+
+	template<class StreamT>
+	void HttpListener<StreamT>::onAccept(const boost::system::error_code& aError) noexcept {
+		Lock l(cs);
+		if (!listening) {
+			boost::system::error_code ec;
+			socket.close(ec);
+			return;
+		}
+
+		if (!aError) {
+			auto con = std::make_shared<ConnectionType>(std::move(socket), tlsContextF ? tlsContextF() : nullptr, ios, limits, requestHandler, upgradeHandler);
+
+			// Forget the connections that have been closed
+			connections.erase(std::remove_if(connections.begin(), connections.end(), [](const std::weak_ptr<ConnectionType>& c) {
+				return c.expired();
+			}), connections.end());
+
+			connections.push_back(con);
+			con->start();
+		} else {
+			dcdebug("HttpListener: failed to accept a connection (%s)\n", aError.message().c_str());
+		}
+
+		socket = boost::asio::ip::tcp::socket(ios);
+		accept();
+	}
+
+	template class HttpListener<HttpPlainStream>;
+	template class HttpListener<HttpTlsStream>;
+}
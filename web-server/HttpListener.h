@@ -0,0 +1,78 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_HTTP_LISTENER_H
+#define DCPLUSPLUS_DCPP_HTTP_LISTENER_H
+
+#include "stdinc.h"
+
+#include "HttpConnection.h"
+
+#include <airdcpp/CriticalSection.h>
+
+
+namespace webserver {
+	// Accepts connections and serves them as persistent HTTP connections
+	template<class StreamT>
+	class HttpListener {
+	public:
+		typedef HttpConnection<StreamT> ConnectionType;
+
+		// Returns the context for new TLS connections
+		typedef std::function<context_ptr()> TlsContextF;
+
+		HttpListener(boost::asio::io_service& aIos, const HttpConnectionLimits& aLimits, const typename ConnectionType::RequestHandler& aRequestHandler, const typename ConnectionType::UpgradeHandler& aUpgradeHandler, const TlsContextF& aTlsContextF = nullptr);
+		~HttpListener();
+
+		// Throws std::exception on errors
+		void listen(const string& aBindAddress, const string& aPort);
+		void listen(const boost::asio::ip::tcp& aProtocol, uint16_t aPort);
+
+		// Stops listening and closes all open connections
+		void stop() noexcept;
+
+		bool isListening() const noexcept;
+
+		HttpListener(HttpListener&) = delete;
+		HttpListener& operator=(HttpListener&) = delete;
+	private:
+		void listen(const boost::asio::ip::tcp::endpoint& aEndpoint);
+
+		void accept() noexcept;
+		void onAccept(const boost::system::error_code& aError) noexcept;
+
+		boost::asio::io_service& ios;
+		boost::asio::ip::tcp::acceptor acceptor;
+		boost::asio::ip::tcp::socket socket;
+
+		const HttpConnectionLimits limits;
+		const typename ConnectionType::RequestHandler requestHandler;
+		const typename ConnectionType::UpgradeHandler upgradeHandler;
+		const TlsContextF tlsContextF;
+
+		vector<std::weak_ptr<ConnectionType>> connections;
+		mutable CriticalSection cs;
+
+		bool listening = false;
+	};
+
+	typedef HttpListener<HttpPlainStream> HttpPlainListener;
+	typedef HttpListener<HttpTlsStream> HttpTlsListener;
+}
+
+#endif
@@ -20,10 +20,13 @@
 
 #include <web-server/HttpUtil.h>
 
+#include <airdcpp/StringTokenizer.h>
 #include <airdcpp/Util.h>
 
 #include "boost/algorithm/string/replace.hpp"
 
+#include <zlib.h>
+
 //#include <sstream>
 
 namespace webserver {
@@ -229,4 +232,65 @@ namespace webserver {
 	string HttpUtil::parseAuthToken(const websocketpp::http::parser::request& aRequest) noexcept {
 		return aRequest.get_header("Authorization");
 	}
-}
\ No newline at end of file
+
+	bool HttpUtil::acceptsEncoding(const websocketpp::http::parser::request& aRequest, const string& aEncoding) noexcept {
+		const auto& header = aRequest.get_header("Accept-Encoding");
+		if (header.empty()) {
+			return false;
+		}
+
+		StringTokenizer<string> st(header, ',');
+		for (const auto& token : st.getTokens()) {
+			// Coding with optional parameters, e.g. "gzip;q=0.5"
+			auto nameStart = token.find_first_not_of(" \t");
+			if (nameStart == string::npos) {
+				continue;
+			}
+
+			auto paramStart = token.find(';', nameStart);
+			auto nameEnd = token.find_last_not_of(" \t", paramStart == string::npos ? string::npos : paramStart - 1);
+			if (nameEnd == string::npos || nameEnd < nameStart || Util::stricmp(token.substr(nameStart, nameEnd - nameStart + 1), aEncoding) != 0) {
+				continue;
+			}
+
+			if (paramStart != string::npos) {
+				auto qPos = token.find("q=", paramStart);
+				if (qPos != string::npos && Util::toDouble(token.substr(qPos + 2)) <= 0) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	bool HttpUtil::gzipCompress(const string& aData, string& output_) noexcept {
+		z_stream zs;
+		memset(&zs, 0, sizeof(zs));
+
+		// Add 16 to the window bits to get a gzip header
+		if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			return false;
+		}
+
+		output_.resize(deflateBound(&zs, static_cast<uLong>(aData.size())));
+
+		zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(aData.data()));
+		zs.avail_in = static_cast<uInt>(aData.size());
+		zs.next_out = reinterpret_cast<Bytef*>(&output_[0]);
+		zs.avail_out = static_cast<uInt>(output_.size());
+
+		auto ret = deflate(&zs, Z_FINISH);
+		deflateEnd(&zs);
+
+		if (ret != Z_STREAM_END) {
+			output_.clear();
+			return false;
+		}
+
+		output_.resize(zs.total_out);
+		return true;
+	}
+}
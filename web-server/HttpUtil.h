@@ -43,6 +43,13 @@ namespace webserver {
 		static bool isStatusOk(int aCode) noexcept;
 		static bool parseStatus(const string& aResponse, int& code_, string& text_) noexcept;
 		static string parseAuthToken(const websocketpp::http::parser::request& aRequest) noexcept;
+
+		// Returns true if the content coding is listed in the Accept-Encoding header (and it isn't disabled with q=0)
+		static bool acceptsEncoding(const websocketpp::http::parser::request& aRequest, const string& aEncoding) noexcept;
+
+		// Compresses the data in gzip format
+		// Returns false if compression fails
+		static bool gzipCompress(const string& aData, string& output_) noexcept;
 	};
 }
 
@@ -0,0 +1,122 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/JsonArena.h>
+
+#include <atomic>
+
+
+namespace webserver {
+	namespace {
+		std::atomic<uint64_t> totalEvents { 0 };
+		std::atomic<uint64_t> totalAllocations { 0 };
+		std::atomic<uint64_t> totalHeapAllocations { 0 };
+		std::atomic<uint64_t> maxEventAllocations { 0 };
+
+		const size_t ALIGNMENT = alignof(std::max_align_t);
+
+		size_t alignSize(size_t aSize) noexcept {
+			return (aSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		}
+	}
+
+	JsonArena& JsonArena::getThreadArena() noexcept {
+		thread_local JsonArena arena;
+		return arena;
+	}
+
+	JsonArena::~JsonArena() {
+		dcassert(liveAllocations == 0);
+		for (auto b : blocks) {
+			::operator delete(b);
+		}
+	}
+
+	void* JsonArena::allocate(size_t aSize) {
+		liveAllocations++;
+		eventAllocations++;
+
+		if (aSize > MAX_ARENA_ALLOCATION) {
+			eventHeapAllocations++;
+			return ::operator new(aSize);
+		}
+
+		aSize = alignSize(aSize);
+		if (blocks.empty() || blockPos + aSize > BLOCK_SIZE) {
+			if (!blocks.empty()) {
+				currentBlock++;
+			}
+
+			if (currentBlock == blocks.size()) {
+				blocks.push_back(static_cast<char*>(::operator new(BLOCK_SIZE)));
+			}
+
+			blockPos = 0;
+		}
+
+		auto ret = blocks[currentBlock] + blockPos;
+		blockPos += aSize;
+		return ret;
+	}
+
+	void JsonArena::deallocate(void* aPtr, size_t aSize) noexcept {
+		dcassert(liveAllocations > 0);
+		if (aSize > MAX_ARENA_ALLOCATION) {
+			::operator delete(aPtr);
+		}
+
+		liveAllocations--;
+		if (liveAllocations == 0) {
+			reset();
+		}
+	}
+
+	void JsonArena::reset() noexcept {
+		totalEvents++;
+		totalAllocations += eventAllocations;
+		totalHeapAllocations += eventHeapAllocations;
+
+		// Racy but good enough for statistics
+		if (eventAllocations > maxEventAllocations.load()) {
+			maxEventAllocations.store(eventAllocations);
+		}
+
+		eventAllocations = 0;
+		eventHeapAllocations = 0;
+
+		// Release the blocks that were needed only for exceptionally large events
+		while (blocks.size() > MAX_IDLE_BLOCKS) {
+			::operator delete(blocks.back());
+			blocks.pop_back();
+		}
+
+		currentBlock = 0;
+		blockPos = 0;
+	}
+
+	JsonArena::Stats JsonArena::getStats() noexcept {
+		return {
+			totalEvents.load(),
+			totalAllocations.load(),
+			totalHeapAllocations.load(),
+			maxEventAllocations.load(),
+		};
+	}
+}
@@ -0,0 +1,116 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_JSON_ARENA_H
+#define DCPLUSPLUS_DCPP_JSON_ARENA_H
+
+#include "stdinc.h"
+
+
+namespace webserver {
+	// Per-thread bump allocator for short-lived JSON values
+	//
+	// Memory is handed out sequentially from fixed size blocks and deallocations only decrease the count
+	// of live allocations. The arena is rewound once the count drops to zero, which happens when the
+	// values built for an event have been sent and destroyed. Values allocated from the arena must
+	// therefore be destroyed in the same thread and they shouldn't be stored for later use.
+	class JsonArena {
+	public:
+		struct Stats {
+			// Arena reset cycles (one per sent event)
+			uint64_t events;
+			uint64_t allocations;
+
+			// Allocations that were too large for the arena blocks
+			uint64_t heapAllocations;
+
+			// Most allocations made during a single cycle
+			uint64_t maxEventAllocations;
+		};
+
+		// Allocations larger than this are passed to the global heap
+		static const size_t MAX_ARENA_ALLOCATION = 4 * 1024;
+		static const size_t BLOCK_SIZE = 64 * 1024;
+
+		// Number of blocks that are kept allocated after resetting the arena
+		static const size_t MAX_IDLE_BLOCKS = 4;
+
+		static JsonArena& getThreadArena() noexcept;
+
+		void* allocate(size_t aSize);
+		void deallocate(void* aPtr, size_t aSize) noexcept;
+
+		static Stats getStats() noexcept;
+
+		JsonArena() = default;
+		~JsonArena();
+
+		JsonArena(const JsonArena&) = delete;
+		JsonArena& operator=(const JsonArena&) = delete;
+	private:
+		void reset() noexcept;
+
+		vector<char*> blocks;
+		size_t currentBlock = 0;
+		size_t blockPos = 0;
+
+		size_t liveAllocations = 0;
+		size_t eventAllocations = 0;
+		size_t eventHeapAllocations = 0;
+	};
+
+	// Stateless allocator for nlohmann::basic_json that uses the arena of the current thread
+	template<class T>
+	class JsonArenaAllocator {
+	public:
+		typedef T value_type;
+
+		JsonArenaAllocator() noexcept = default;
+
+		template<class U>
+		JsonArenaAllocator(const JsonArenaAllocator<U>&) noexcept { }
+
+		T* allocate(size_t aCount) {
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types aren't supported");
+			return static_cast<T*>(JsonArena::getThreadArena().allocate(aCount * sizeof(T)));
+		}
+
+		void deallocate(T* aPtr, size_t aCount) noexcept {
+			JsonArena::getThreadArena().deallocate(aPtr, aCount * sizeof(T));
+		}
+
+		template<class U>
+		bool operator==(const JsonArenaAllocator<U>&) const noexcept {
+			return true;
+		}
+
+		template<class U>
+		bool operator!=(const JsonArenaAllocator<U>&) const noexcept {
+			return false;
+		}
+	};
+
+	// JSON type for building event data
+	//
+	// Object and array nodes are allocated from the arena of the current thread (string contents
+	// still use the regular string type so that the values can be converted to/from std::string freely).
+	// The values must be created and destroyed within the same event handler call.
+	using EventJson = nlohmann::basic_json<std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t, double, JsonArenaAllocator>;
+}
+
+#endif
@@ -0,0 +1,191 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/JsonScanner.h>
+
+
+namespace webserver {
+	void JsonScanner::forEachField(std::string_view aJson, const FieldF& aHandler) {
+		auto pos = skipWhitespace(aJson, 0);
+		expect(aJson, pos, '{');
+
+		pos = skipWhitespace(aJson, pos + 1);
+		if (pos < aJson.size() && aJson[pos] == '}') {
+			pos++;
+		} else {
+			for (;;) {
+				// Key
+				expect(aJson, pos, '"');
+				auto keyEnd = skipString(aJson, pos);
+
+				string key;
+				if (std::find(aJson.begin() + pos, aJson.begin() + keyEnd, '\\') != aJson.begin() + keyEnd) {
+					key = json::parse(aJson.begin() + pos, aJson.begin() + keyEnd).get<string>();
+				} else {
+					key = string(aJson.substr(pos + 1, keyEnd - pos - 2));
+				}
+
+				pos = skipWhitespace(aJson, keyEnd);
+				expect(aJson, pos, ':');
+
+				// Value
+				auto valueStart = skipWhitespace(aJson, pos + 1);
+				auto valueEnd = skipValue(aJson, valueStart);
+				aHandler(key, JsonRange(aJson, valueStart, valueEnd - valueStart));
+
+				pos = skipWhitespace(aJson, valueEnd);
+				if (pos < aJson.size() && aJson[pos] == ',') {
+					pos = skipWhitespace(aJson, pos + 1);
+					continue;
+				}
+
+				expect(aJson, pos, '}');
+				pos++;
+				break;
+			}
+		}
+
+		pos = skipWhitespace(aJson, pos);
+		if (pos != aJson.size()) {
+			throw syntaxError(pos, "unexpected content after the end of the object");
+		}
+	}
+
+	void JsonScanner::forEachElement(std::string_view aJson, const ElementF& aHandler) {
+		auto pos = skipWhitespace(aJson, 0);
+		expect(aJson, pos, '[');
+
+		pos = skipWhitespace(aJson, pos + 1);
+		if (pos < aJson.size() && aJson[pos] == ']') {
+			pos++;
+		} else {
+			for (;;) {
+				auto valueEnd = skipValue(aJson, pos);
+				aHandler(JsonRange(aJson, pos, valueEnd - pos));
+
+				pos = skipWhitespace(aJson, valueEnd);
+				if (pos < aJson.size() && aJson[pos] == ',') {
+					pos = skipWhitespace(aJson, pos + 1);
+					continue;
+				}
+
+				expect(aJson, pos, ']');
+				pos++;
+				break;
+			}
+		}
+
+		pos = skipWhitespace(aJson, pos);
+		if (pos != aJson.size()) {
+			throw syntaxError(pos, "unexpected content after the end of the array");
+		}
+	}
+
+	size_t JsonScanner::skipWhitespace(std::string_view aJson, size_t aPos) noexcept {
+		while (aPos < aJson.size()) {
+			auto c = aJson[aPos];
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+				break;
+			}
+
+			aPos++;
+		}
+
+		return aPos;
+	}
+
+	size_t JsonScanner::skipString(std::string_view aJson, size_t aPos) {
+		dcassert(aJson[aPos] == '"');
+		for (auto i = aPos + 1; i < aJson.size(); ++i) {
+			if (aJson[i] == '\\') {
+				i++;
+			} else if (aJson[i] == '"') {
+				return i + 1;
+			}
+		}
+
+		throw syntaxError(aPos, "unterminated string");
+	}
+
+	size_t JsonScanner::skipValue(std::string_view aJson, size_t aPos) {
+		if (aPos >= aJson.size()) {
+			throw syntaxError(aPos, "value expected");
+		}
+
+		switch (aJson[aPos]) {
+			case '"': return skipString(aJson, aPos);
+			case '{':
+			case '[': {
+				int depth = 0;
+				for (auto i = aPos; i < aJson.size(); ++i) {
+					switch (aJson[i]) {
+						case '"': {
+							i = skipString(aJson, i) - 1;
+							break;
+						}
+						case '{':
+						case '[': {
+							depth++;
+							break;
+						}
+						case '}':
+						case ']': {
+							depth--;
+							if (depth == 0) {
+								return i + 1;
+							}
+							break;
+						}
+					}
+				}
+
+				throw syntaxError(aPos, "unterminated object or array");
+			}
+			default: {
+				// Literal or number
+				auto end = aPos;
+				while (end < aJson.size()) {
+					auto c = aJson[end];
+					if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+						break;
+					}
+
+					end++;
+				}
+
+				if (end == aPos) {
+					throw syntaxError(aPos, "value expected");
+				}
+
+				return end;
+			}
+		}
+	}
+
+	void JsonScanner::expect(std::string_view aJson, size_t aPos, char aChar) {
+		if (aPos >= aJson.size() || aJson[aPos] != aChar) {
+			throw syntaxError(aPos, string("'") + aChar + "' expected");
+		}
+	}
+
+	json::parse_error JsonScanner::syntaxError(size_t aPos, const string& aMessage) noexcept {
+		return json::parse_error::create(101, aPos + 1, "syntax error - " + aMessage);
+	}
+}
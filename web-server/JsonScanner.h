@@ -0,0 +1,84 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_JSON_SCANNER_H
+#define DCPLUSPLUS_DCPP_JSON_SCANNER_H
+
+#include "stdinc.h"
+
+#include <string_view>
+
+namespace webserver {
+	// Unparsed JSON value inside a larger string
+	// The referenced string must remain valid for as long as the range is being used
+	class JsonRange {
+	public:
+		JsonRange() = default;
+		explicit JsonRange(std::string_view aSource) noexcept : data(aSource.data()), length(aSource.size()) { }
+		JsonRange(std::string_view aSource, size_t aPos, size_t aLength) noexcept : data(aSource.data() + aPos), length(aLength) { }
+
+		bool empty() const noexcept {
+			return length == 0;
+		}
+
+		bool isNull() const noexcept {
+			return length == 4 && memcmp(data, "null", 4) == 0;
+		}
+
+		std::string_view view() const noexcept {
+			return std::string_view(data, length);
+		}
+
+		// Throws json::parse_error
+		json parse() const {
+			return json::parse(data, data + length);
+		}
+	private:
+		const char* data = nullptr;
+		size_t length = 0;
+	};
+
+	// On-demand scanner for top-level object fields
+	//
+	// Only the structure of the values is checked (strings must be terminated and brackets balanced),
+	// the values themselves are validated when they are parsed.
+	class JsonScanner {
+	public:
+		typedef std::function<void(const string& aKey, const JsonRange& aValue)> FieldF;
+		typedef std::function<void(const JsonRange& aValue)> ElementF;
+
+		// Calls the handler for each field of the object (the keys are passed unescaped)
+		// Throws json::parse_error if the text isn't a valid object
+		static void forEachField(std::string_view aJson, const FieldF& aHandler);
+
+		// Calls the handler for each element of the array
+		// Throws json::parse_error if the text isn't a valid array
+		static void forEachElement(std::string_view aJson, const ElementF& aHandler);
+	private:
+		static size_t skipWhitespace(std::string_view aJson, size_t aPos) noexcept;
+
+		// Return the position after the end of the value
+		static size_t skipString(std::string_view aJson, size_t aPos);
+		static size_t skipValue(std::string_view aJson, size_t aPos);
+
+		static void expect(std::string_view aJson, size_t aPos, char aChar);
+		static json::parse_error syntaxError(size_t aPos, const string& aMessage) noexcept;
+	};
+}
+
+#endif
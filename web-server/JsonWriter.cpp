@@ -0,0 +1,223 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/JsonWriter.h>
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define JSON_WRITER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define JSON_WRITER_SSE2
+#endif
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+
+namespace webserver {
+	namespace {
+		string toHexByte(uint8_t aByte) noexcept {
+			char buf[3];
+			snprintf(buf, sizeof(buf), "%.2X", aByte);
+			return buf;
+		}
+
+		// Returns the length of a valid UTF-8 sequence starting at aPos (the lead byte must be non-ASCII)
+		// Throws the same errors as json::dump()
+		size_t getSequenceLength(const string& aStr, size_t aPos) {
+			auto lead = static_cast<uint8_t>(aStr[aPos]);
+
+			size_t len;
+			uint8_t secondMin = 0x80, secondMax = 0xBF;
+			if (lead >= 0xC2 && lead <= 0xDF) {
+				len = 2;
+			} else if (lead >= 0xE0 && lead <= 0xEF) {
+				len = 3;
+				if (lead == 0xE0) {
+					secondMin = 0xA0; // overlong
+				} else if (lead == 0xED) {
+					secondMax = 0x9F; // surrogates
+				}
+			} else if (lead >= 0xF0 && lead <= 0xF4) {
+				len = 4;
+				if (lead == 0xF0) {
+					secondMin = 0x90; // overlong
+				} else if (lead == 0xF4) {
+					secondMax = 0x8F; // above U+10FFFF
+				}
+			} else {
+				throw json::type_error::create(316, "invalid UTF-8 byte at index " + std::to_string(aPos) + ": 0x" + toHexByte(lead));
+			}
+
+			for (size_t i = 1; i < len; ++i) {
+				if (aPos + i >= aStr.size()) {
+					throw json::type_error::create(316, "incomplete UTF-8 string; last byte: 0x" + toHexByte(static_cast<uint8_t>(aStr.back())));
+				}
+
+				auto c = static_cast<uint8_t>(aStr[aPos + i]);
+				auto min = i == 1 ? secondMin : static_cast<uint8_t>(0x80);
+				auto max = i == 1 ? secondMax : static_cast<uint8_t>(0xBF);
+				if (c < min || c > max) {
+					throw json::type_error::create(316, "invalid UTF-8 byte at index " + std::to_string(aPos + i) + ": 0x" + toHexByte(c));
+				}
+			}
+
+			return len;
+		}
+
+#if defined(JSON_WRITER_AVX2) || defined(JSON_WRITER_SSE2)
+		inline size_t countTrailingZeros(uint32_t aMask) noexcept {
+#ifdef _MSC_VER
+			unsigned long ret;
+			_BitScanForward(&ret, aMask);
+			return static_cast<size_t>(ret);
+#else
+			return static_cast<size_t>(__builtin_ctz(aMask));
+#endif
+		}
+#endif
+
+		// Returns the position of the first character at or after aPos that either needs to be escaped
+		// or starts a multibyte UTF-8 sequence (aSize if there are no such characters)
+		size_t findSpecialChar(const char* aData, size_t aPos, size_t aSize) noexcept {
+#if defined(JSON_WRITER_AVX2)
+			const auto quote = _mm256_set1_epi8('"');
+			const auto backslash = _mm256_set1_epi8('\\');
+			const auto space = _mm256_set1_epi8(0x20);
+			for (; aPos + 32 <= aSize; aPos += 32) {
+				auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aData + aPos));
+
+				// Signed comparison catches both control characters and bytes >= 0x80
+				auto special = _mm256_or_si256(
+					_mm256_cmpgt_epi8(space, v),
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash))
+				);
+
+				auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+				if (mask != 0) {
+					return aPos + countTrailingZeros(mask);
+				}
+			}
+#elif defined(JSON_WRITER_SSE2)
+			const auto quote = _mm_set1_epi8('"');
+			const auto backslash = _mm_set1_epi8('\\');
+			const auto space = _mm_set1_epi8(0x20);
+			for (; aPos + 16 <= aSize; aPos += 16) {
+				auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aData + aPos));
+
+				// Signed comparison catches both control characters and bytes >= 0x80
+				auto special = _mm_or_si128(
+					_mm_cmplt_epi8(v, space),
+					_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash))
+				);
+
+				auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+				if (mask != 0) {
+					return aPos + countTrailingZeros(mask);
+				}
+			}
+#endif
+
+			// Scalar fallback and the remaining tail
+			for (; aPos < aSize; ++aPos) {
+				auto c = static_cast<uint8_t>(aData[aPos]);
+				if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') {
+					break;
+				}
+			}
+
+			return aPos;
+		}
+	}
+
+	void JsonWriter::appendEscaped(const string& aStr, string& output_) {
+		const auto size = aStr.size();
+
+		// Characters that don't need escaping are copied in runs
+		size_t runStart = 0;
+		size_t pos = 0;
+		while (pos < size) {
+			pos = findSpecialChar(aStr.data(), pos, size);
+			if (pos == size) {
+				break;
+			}
+
+			auto c = static_cast<uint8_t>(aStr[pos]);
+			if (c >= 0x80) {
+				pos += getSequenceLength(aStr, pos);
+				continue;
+			}
+
+			output_.append(aStr, runStart, pos - runStart);
+			switch (c) {
+				case '"': output_ += "\\\""; break;
+				case '\\': output_ += "\\\\"; break;
+				case '\b': output_ += "\\b"; break;
+				case '\f': output_ += "\\f"; break;
+				case '\n': output_ += "\\n"; break;
+				case '\r': output_ += "\\r"; break;
+				case '\t': output_ += "\\t"; break;
+				default: {
+					char buf[7];
+					snprintf(buf, sizeof(buf), "\\u%04x", c);
+					output_ += buf;
+					break;
+				}
+			}
+
+			pos++;
+			runStart = pos;
+		}
+
+		output_.append(aStr, runStart, size - runStart);
+	}
+
+	string JsonWriter::formatKey(const string& aKey) {
+		string ret = "\"";
+		appendEscaped(aKey, ret);
+		ret += "\":";
+		return ret;
+	}
+
+	void JsonWriter::writeNumber(double aValue) noexcept {
+		if (!std::isfinite(aValue)) {
+			writeNull();
+			return;
+		}
+
+		beginValue();
+
+		std::array<char, 64> buf;
+		auto end = nlohmann::detail::to_chars(buf.data(), buf.data() + buf.size(), aValue);
+		output.append(buf.data(), static_cast<size_t>(end - buf.data()));
+	}
+
+	void JsonWriter::writeInteger(int64_t aValue) noexcept {
+		beginValue();
+		output += std::to_string(aValue);
+	}
+
+	void JsonWriter::writeUnsigned(uint64_t aValue) noexcept {
+		beginValue();
+		output += std::to_string(aValue);
+	}
+}
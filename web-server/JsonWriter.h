@@ -0,0 +1,231 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_JSON_WRITER_H
+#define DCPLUSPLUS_DCPP_JSON_WRITER_H
+
+#include "stdinc.h"
+
+#include <string_view>
+
+
+namespace webserver {
+	// Writes compact JSON text directly into a string buffer without building a DOM first
+	//
+	// The caller is responsible for producing a well-formed structure (keys are only written inside objects
+	// and every start call has a matching end call). The output is identical to json::dump() for the same
+	// data, except that object keys are written in the order in which they were added.
+	class JsonWriter {
+	public:
+		JsonWriter() = default;
+		explicit JsonWriter(size_t aReserve) {
+			output.reserve(aReserve);
+		}
+
+		JsonWriter(JsonWriter&&) = default;
+		JsonWriter& operator=(JsonWriter&&) = default;
+
+		JsonWriter(const JsonWriter&) = delete;
+		JsonWriter& operator=(const JsonWriter&) = delete;
+
+		void startObject() noexcept {
+			beginValue();
+			output += '{';
+			needComma = false;
+		}
+
+		void endObject() noexcept {
+			output += '}';
+			needComma = true;
+		}
+
+		void startArray() noexcept {
+			beginValue();
+			output += '[';
+			needComma = false;
+		}
+
+		void endArray() noexcept {
+			output += ']';
+			needComma = true;
+		}
+
+		// Key that hasn't been escaped yet
+		// Throws type_error in case of invalid UTF-8
+		void writeKey(const string& aKey) {
+			beginValue();
+			output += '"';
+			appendEscaped(aKey, output);
+			output += "\":";
+			needComma = false;
+		}
+
+		// Key fragment created with formatKey
+		void writeFormattedKey(const string& aKey) noexcept {
+			beginValue();
+			output += aKey;
+			needComma = false;
+		}
+
+		// Throws type_error in case of invalid UTF-8
+		void writeString(const string& aValue) {
+			beginValue();
+			output += '"';
+			appendEscaped(aValue, output);
+			output += '"';
+		}
+
+		void writeNumber(double aValue) noexcept;
+		void writeInteger(int64_t aValue) noexcept;
+		void writeUnsigned(uint64_t aValue) noexcept;
+
+		void writeBool(bool aValue) noexcept {
+			beginValue();
+			output += aValue ? "true" : "false";
+		}
+
+		void writeNull() noexcept {
+			beginValue();
+			output += "null";
+		}
+
+		// Throws type_error in case of invalid UTF-8
+		void writeJson(const json& aJson) {
+			writeBasicJson(aJson);
+		}
+
+		// Overload for JSON types with custom allocators (such as EventJson)
+		template<class BasicJsonT, typename std::enable_if<nlohmann::detail::is_basic_json<BasicJsonT>::value && !std::is_same<BasicJsonT, json>::value, int>::type = 0>
+		void writeJson(const BasicJsonT& aJson) {
+			writeBasicJson(aJson);
+		}
+
+		// Value that has been serialized already (must be a valid JSON value)
+		void writeRaw(std::string_view aSerializedValue) noexcept {
+			beginValue();
+			output += aSerializedValue;
+		}
+
+		template<class ValueT>
+		void writeField(const string& aKey, const ValueT& aValue) {
+			writeKey(aKey);
+			writeJson(aValue);
+		}
+
+		bool empty() const noexcept {
+			return output.empty();
+		}
+
+		size_t size() const noexcept {
+			return output.size();
+		}
+
+		const string& str() const noexcept {
+			return output;
+		}
+
+		string release() noexcept {
+			needComma = false;
+			return std::move(output);
+		}
+
+		// Faster replacement for json::dump() (the output is identical)
+		// Throws type_error in case of invalid UTF-8
+		template<class BasicJsonT>
+		static string dump(const BasicJsonT& aJson) {
+			JsonWriter writer;
+			writer.writeJson(aJson);
+			return writer.release();
+		}
+
+		// Returns the quoted and escaped key followed by a colon so that it can be reused with writeFormattedKey
+		// Throws type_error in case of invalid UTF-8
+		static string formatKey(const string& aKey);
+
+		// Appends the string escaped the same way as json::dump() does (without the surrounding quotes)
+		// Characters that don't need escaping are scanned with SIMD instructions when available
+		// Throws type_error in case of invalid UTF-8
+		static void appendEscaped(const string& aStr, string& output_);
+	private:
+		template<class BasicJsonT>
+		void writeBasicJson(const BasicJsonT& aJson) {
+			switch (aJson.type()) {
+				case nlohmann::detail::value_t::object: {
+					startObject();
+					for (const auto& p : aJson.items()) {
+						writeKey(p.key());
+						writeBasicJson(p.value());
+					}
+					endObject();
+					break;
+				}
+				case nlohmann::detail::value_t::array: {
+					startArray();
+					for (const auto& v : aJson) {
+						writeBasicJson(v);
+					}
+					endArray();
+					break;
+				}
+				case nlohmann::detail::value_t::string: {
+					writeString(aJson.template get_ref<const typename BasicJsonT::string_t&>());
+					break;
+				}
+				case nlohmann::detail::value_t::number_float: {
+					writeNumber(aJson.template get<double>());
+					break;
+				}
+				case nlohmann::detail::value_t::number_integer: {
+					writeInteger(aJson.template get<int64_t>());
+					break;
+				}
+				case nlohmann::detail::value_t::number_unsigned: {
+					writeUnsigned(aJson.template get<uint64_t>());
+					break;
+				}
+				case nlohmann::detail::value_t::boolean: {
+					writeBool(aJson.template get<bool>());
+					break;
+				}
+				case nlohmann::detail::value_t::null: {
+					writeNull();
+					break;
+				}
+				default: {
+					// Binary values and discarded values
+					beginValue();
+					nlohmann::detail::serializer<BasicJsonT> s(nlohmann::detail::output_adapter<char>(output), ' ');
+					s.dump(aJson, false, false, 0);
+				}
+			}
+		}
+
+		void beginValue() noexcept {
+			if (needComma) {
+				output += ',';
+			}
+
+			needComma = true;
+		}
+
+		string output;
+		bool needComma = false;
+	};
+}
+
+#endif
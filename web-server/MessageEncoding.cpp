@@ -0,0 +1,111 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/MessageEncoding.h>
+#include <web-server/JsonWriter.h>
+
+#include <airdcpp/Util.h>
+
+
+namespace webserver {
+	bool MessageEncoding::parse(const string& aName, Type& type_) noexcept {
+		if (aName == "json") {
+			type_ = TYPE_JSON;
+		} else if (aName == "cbor") {
+			type_ = TYPE_CBOR;
+		} else if (aName == "msgpack") {
+			type_ = TYPE_MSGPACK;
+		} else {
+			return false;
+		}
+
+		return true;
+	}
+
+	string MessageEncoding::toString(Type aType) noexcept {
+		switch (aType) {
+			case TYPE_CBOR: return "cbor";
+			case TYPE_MSGPACK: return "msgpack";
+			default: return "json";
+		}
+	}
+
+	string MessageEncoding::fromJsonText(Type aType, const string& aText) {
+		if (!isBinary(aType)) {
+			return aText;
+		}
+
+		return encode(aType, json::parse(aText));
+	}
+
+	string MessageEncoding::encode(Type aType, const json& aJson) {
+		string ret;
+		switch (aType) {
+			case TYPE_CBOR: json::to_cbor(aJson, ret); break;
+			case TYPE_MSGPACK: json::to_msgpack(aJson, ret); break;
+			default: ret = JsonWriter::dump(aJson); break;
+		}
+
+		return ret;
+	}
+
+	string MessageEncoding::describe(Type aType, size_t aSize) noexcept {
+		return "(" + toString(aType) + ", " + Util::toString(aSize) + " bytes)";
+	}
+
+	json MessageEncoding::decode(Type aType, const string& aMessage) {
+		switch (aType) {
+			case TYPE_CBOR: return json::from_cbor(aMessage);
+			case TYPE_MSGPACK: return json::from_msgpack(aMessage);
+			default: return json::parse(aMessage);
+		}
+	}
+
+	const string& MessageFrame::getEncoded(MessageEncoding::Type aType) const {
+		if (!MessageEncoding::isBinary(aType)) {
+			return text;
+		}
+
+		std::call_once(encodedFlags[aType], [this, aType] {
+			encoded[aType] = MessageEncoding::fromJsonText(aType, text);
+		});
+
+		return encoded[aType];
+	}
+
+	string MessageFrame::encodeArray(MessageEncoding::Type aType, const vector<MessageFramePtr>& aMessages) {
+		size_t size = aMessages.size() + 2;
+		for (const auto& m: aMessages) {
+			size += m->getText().size();
+		}
+
+		JsonWriter writer(size);
+		writer.startArray();
+		for (const auto& m: aMessages) {
+			writer.writeRaw(m->getText());
+		}
+
+		writer.endArray();
+
+		// The batch is sent only once so the encodings of the individual messages aren't needed
+		auto text = writer.release();
+		return MessageEncoding::isBinary(aType) ? MessageEncoding::fromJsonText(aType, text) : text;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_MESSAGE_ENCODING_H
+#define DCPLUSPLUS_DCPP_MESSAGE_ENCODING_H
+
+#include "stdinc.h"
+
+#include <array>
+#include <mutex>
+
+
+namespace webserver {
+	// Wire format of socket messages
+	//
+	// Messages are always built as JSON (the binary formats have the same data model).
+	// JSON messages are sent in text frames and other formats in binary frames.
+	class MessageEncoding {
+	public:
+		enum Type : uint8_t {
+			TYPE_JSON,
+			TYPE_CBOR,
+			TYPE_MSGPACK,
+			TYPE_LAST
+		};
+
+		// Accepted names: json, cbor, msgpack
+		static bool parse(const string& aName, Type& type_) noexcept;
+		static string toString(Type aType) noexcept;
+
+		static bool isBinary(Type aType) noexcept {
+			return aType != TYPE_JSON;
+		}
+
+		// Converts serialized JSON into the wanted encoding (JSON text is returned as it is)
+		// Throws json::parse_error
+		static string fromJsonText(Type aType, const string& aText);
+
+		// Throws json::type_error if the value can't be serialized (invalid UTF-8)
+		static string encode(Type aType, const json& aJson);
+
+		// Description of a binary message for debug output
+		static string describe(Type aType, size_t aSize) noexcept;
+
+		// Throws json::parse_error
+		static json decode(Type aType, const string& aMessage);
+	};
+
+	// Serialized event message that may be sent to multiple sockets
+	// Binary encodings are converted from the JSON text when they are needed for the first time
+	class MessageFrame {
+	public:
+		explicit MessageFrame(string&& aText) noexcept : text(std::move(aText)) { }
+
+		const string& getText() const noexcept {
+			return text;
+		}
+
+		// Returns the message in the wanted encoding
+		// Throws json::parse_error
+		const string& getEncoded(MessageEncoding::Type aType) const;
+
+		// Returns the messages as an array in the wanted encoding
+		// Throws json::parse_error
+		static string encodeArray(MessageEncoding::Type aType, const vector<MessageFramePtr>& aMessages);
+
+		MessageFrame(MessageFrame&) = delete;
+		MessageFrame& operator=(MessageFrame&) = delete;
+	private:
+		const string text;
+
+		mutable std::array<string, MessageEncoding::TYPE_LAST> encoded;
+		mutable std::array<std::once_flag, MessageEncoding::TYPE_LAST> encodedFlags;
+	};
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_PARALLEL_UTIL_H
+#define DCPLUSPLUS_DCPP_PARALLEL_UTIL_H
+
+#include "stdinc.h"
+
+#include <future>
+#include <thread>
+
+
+namespace webserver {
+	// Helpers for splitting CPU-heavy work over multiple threads
+	// The supplied functions must be safe to call concurrently
+	class ParallelUtil {
+	public:
+		// Number of chunks to use for the specified amount of items (1 = run in the calling thread)
+		static size_t getChunkCount(size_t aItemCount) noexcept {
+			auto threads = std::max(std::thread::hardware_concurrency(), 1U);
+			return std::max<size_t>(std::min<size_t>(threads, aItemCount / MIN_CHUNK_SIZE), 1);
+		}
+
+		// Returns the items for which the predicate returns true, preserving the original order
+		template<class ItemT, class PredicateT>
+		static vector<ItemT> filter(const vector<ItemT>& aItems, const PredicateT& aPredicate) {
+			auto chunks = getChunkCount(aItems.size());
+			auto chunkSize = (aItems.size() + chunks - 1) / chunks;
+
+			vector<std::future<vector<ItemT>>> tasks;
+			for (size_t start = 0; start < aItems.size(); start += chunkSize) {
+				auto end = std::min(start + chunkSize, aItems.size());
+				tasks.push_back(std::async(std::launch::async, [&aItems, &aPredicate, start, end] {
+					vector<ItemT> ret;
+					for (auto i = start; i < end; ++i) {
+						if (aPredicate(aItems[i])) {
+							ret.push_back(aItems[i]);
+						}
+					}
+
+					return ret;
+				}));
+			}
+
+			vector<ItemT> ret;
+			for (auto& task : tasks) {
+				auto chunkItems = task.get();
+				ret.insert(ret.end(), chunkItems.begin(), chunkItems.end());
+			}
+
+			return ret;
+		}
+
+		// Stable sort that sorts chunks of the range in separate threads and merges them pairwise
+		template<class IterT, class CompareT>
+		static void stableSort(IterT aBegin, IterT aEnd, const CompareT& aLess) {
+			auto count = static_cast<size_t>(std::distance(aBegin, aEnd));
+			auto chunks = getChunkCount(count);
+			if (chunks <= 1) {
+				std::stable_sort(aBegin, aEnd, aLess);
+				return;
+			}
+
+			auto chunkSize = (count + chunks - 1) / chunks;
+
+			// Chunk boundaries
+			vector<IterT> bounds;
+			for (size_t start = 0; start < count; start += chunkSize) {
+				bounds.push_back(std::next(aBegin, start));
+			}
+
+			bounds.push_back(aEnd);
+
+			{
+				vector<std::future<void>> tasks;
+				for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+					tasks.push_back(std::async(std::launch::async, [&aLess, b = bounds[i], e = bounds[i + 1]] {
+						std::stable_sort(b, e, aLess);
+					}));
+				}
+
+				waitAll(tasks);
+			}
+
+			// Merge the neighboring chunks until there's a single chunk left
+			while (bounds.size() > 2) {
+				vector<std::future<void>> tasks;
+				vector<IterT> merged;
+				for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+					merged.push_back(bounds[i]);
+					if (i + 2 < bounds.size()) {
+						tasks.push_back(std::async(std::launch::async, [&aLess, b = bounds[i], m = bounds[i + 1], e = bounds[i + 2]] {
+							std::inplace_merge(b, m, e, aLess);
+						}));
+					}
+				}
+
+				merged.push_back(aEnd);
+				waitAll(tasks);
+				bounds.swap(merged);
+			}
+		}
+	private:
+		// Avoid spawning threads for tiny chunks
+		static const size_t MIN_CHUNK_SIZE = 5000;
+
+		// Rethrows the first exception only after all tasks have finished (the tasks may reference local data)
+		static void waitAll(vector<std::future<void>>& aTasks) {
+			for (auto& task : aTasks) {
+				task.wait();
+			}
+
+			for (auto& task : aTasks) {
+				task.get();
+			}
+		}
+	};
+}
+
+#endif
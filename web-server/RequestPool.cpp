@@ -0,0 +1,126 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "stdinc.h"
+
+#include <web-server/RequestPool.h>
+
+#include <chrono>
+
+
+namespace webserver {
+	RequestPool::RequestPool() noexcept {
+
+	}
+
+	RequestPool::~RequestPool() {
+		stop();
+	}
+
+	void RequestPool::start(int aThreads, size_t aMaxPending) noexcept {
+		dcassert(!threads);
+
+		threadCount = aThreads;
+		maxPending = aMaxPending;
+
+		service.reset();
+		work = make_unique<boost::asio::io_service::work>(service);
+
+		threads = make_unique<boost::thread_group>();
+		for (int x = 0; x < aThreads; ++x) {
+			threads->create_thread(boost::bind(&boost::asio::io_service::run, &service));
+		}
+	}
+
+	void RequestPool::stop() noexcept {
+		if (!threads) {
+			return;
+		}
+
+		// Let the threads finish the queued requests (stopping the service would leave them to be run after the next start)
+		work.reset();
+
+		threads->join_all();
+		threads.reset();
+
+		dcassert(pending == 0);
+	}
+
+	bool RequestPool::reserve() noexcept {
+		auto count = ++pending;
+		if (maxPending > 0 && count > maxPending) {
+			pending--;
+			rejected++;
+			return false;
+		}
+
+		return true;
+	}
+
+	CallBack RequestPool::wrapTask(CallBack&& aTask) noexcept {
+		auto queued = std::chrono::steady_clock::now();
+		return [this, queued, task = std::move(aTask)] {
+			auto queueTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued).count());
+			totalQueueTime += queueTime;
+
+			// Racy but good enough for statistics
+			if (queueTime > maxQueueTime.load()) {
+				maxQueueTime.store(queueTime);
+			}
+
+			pending--;
+			executed++;
+
+			task();
+		};
+	}
+
+	bool RequestPool::post(CallBack&& aTask) noexcept {
+		if (!reserve()) {
+			return false;
+		}
+
+		postReserved(std::move(aTask));
+		return true;
+	}
+
+	void RequestPool::postReserved(CallBack&& aTask) noexcept {
+		service.post(wrapTask(std::move(aTask)));
+	}
+
+	bool RequestPool::post(Strand& aStrand, CallBack&& aTask) noexcept {
+		if (!reserve()) {
+			return false;
+		}
+
+		aStrand.post(wrapTask(std::move(aTask)));
+		return true;
+	}
+
+	RequestPool::Stats RequestPool::getStats() const noexcept {
+		return {
+			executed.load(),
+			inlined.load(),
+			rejected.load(),
+			totalQueueTime.load(),
+			maxQueueTime.load(),
+			pending.load(),
+			threadCount,
+		};
+	}
+}
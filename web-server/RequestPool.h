@@ -0,0 +1,109 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_REQUEST_POOL_H
+#define DCPLUSPLUS_DCPP_REQUEST_POOL_H
+
+#include "stdinc.h"
+
+#include <atomic>
+#include <boost/thread/thread.hpp>
+
+
+namespace webserver {
+	// Bounded thread pool for running API request handlers
+	//
+	// Handlers may block for a long time (filesystem access, searching, hooks...), which would stall accepting
+	// connections and reading/writing data of all other clients if the handlers were run in the IO threads.
+	// The IO threads only parse the requests and post them here. Requests are rejected when too many of them
+	// are waiting for a free thread.
+	class RequestPool {
+	public:
+		typedef boost::asio::io_service::strand Strand;
+
+		struct Stats {
+			// Requests handled by the pool
+			uint64_t executed;
+
+			// Requests handled directly in the IO threads
+			uint64_t inlined;
+
+			// Requests rejected because of a full queue
+			uint64_t rejected;
+
+			// Time that the executed requests spent waiting for a thread (microseconds)
+			uint64_t totalQueueTime;
+			uint64_t maxQueueTime;
+
+			size_t pending;
+			int threads;
+		};
+
+		RequestPool() noexcept;
+		~RequestPool();
+
+		// aMaxPending 0 = unlimited
+		void start(int aThreads, size_t aMaxPending) noexcept;
+
+		// Waits until the queued requests have been handled
+		void stop() noexcept;
+
+		// Returns false if the queue is full
+		bool post(CallBack&& aTask) noexcept;
+
+		// Tasks posted to the same strand are run one at a time and in the original order
+		bool post(Strand& aStrand, CallBack&& aTask) noexcept;
+
+		// Reserve a queue slot for a task that is posted with postReserved
+		// Returns false if the queue is full
+		bool reserve() noexcept;
+		void postReserved(CallBack&& aTask) noexcept;
+
+		void onRequestInlined() noexcept {
+			inlined++;
+		}
+
+		boost::asio::io_service& getService() noexcept {
+			return service;
+		}
+
+		Stats getStats() const noexcept;
+
+		RequestPool(RequestPool&) = delete;
+		RequestPool& operator=(RequestPool&) = delete;
+	private:
+		// Measures the queue time and releases the reserved slot after running the task
+		CallBack wrapTask(CallBack&& aTask) noexcept;
+
+		boost::asio::io_service service;
+		unique_ptr<boost::asio::io_service::work> work;
+		unique_ptr<boost::thread_group> threads;
+
+		int threadCount = 0;
+		size_t maxPending = 0;
+
+		std::atomic<size_t> pending { 0 };
+		std::atomic<uint64_t> executed { 0 };
+		std::atomic<uint64_t> inlined { 0 };
+		std::atomic<uint64_t> rejected { 0 };
+		std::atomic<uint64_t> totalQueueTime { 0 };
+		std::atomic<uint64_t> maxQueueTime { 0 };
+	};
+}
+
+#endif
@@ -29,6 +29,7 @@
 
 #include <airdcpp/AirUtil.h>
 #include <airdcpp/CryptoManager.h>
+#include <airdcpp/File.h>
 #include <airdcpp/LogManager.h>
 #include <airdcpp/SettingsManager.h>
 #include <airdcpp/SimpleXML.h>
@@ -41,6 +42,14 @@
 
 #define HANDSHAKE_TIMEOUT 0 // disabled, affects HTTP downloads
 
+#define EVENT_FLUSH_INTERVAL 50 // milliseconds
+
+#define HTTP_KEEP_ALIVE_TIMEOUT 15 // seconds
+#define HTTP_MAX_KEEP_ALIVE_REQUESTS 100
+
+#define TLS_SESSION_CACHE_SIZE 1024
+#define TLS_SESSION_TIMEOUT (60 * 60) // seconds
+
 namespace webserver {
 	using namespace dcpp;
 	WebServerManager::WebServerManager() : 
@@ -118,21 +127,15 @@ namespace webserver {
 
 	template<class T>
 	void setEndpointHandlers(T& aEndpoint, bool aIsSecure, WebServerManager* aServer) {
-		aEndpoint.set_http_handler(
-			std::bind(&WebServerManager::handleHttpRequest<T>, aServer, &aEndpoint, _1, aIsSecure));
+		// HTTP requests are handled by HttpConnection (only WebSocket connections are passed to websocketpp)
 		aEndpoint.set_message_handler(
 			std::bind(&WebServerManager::handleSocketMessage<T>, aServer, &aEndpoint, _1, _2, aIsSecure));
 
+		aEndpoint.set_validate_handler(std::bind(&WebServerManager::handleValidateSocket<T>, aServer, &aEndpoint, _1));
 		aEndpoint.set_close_handler(std::bind(&WebServerManager::handleSocketDisconnected, aServer, _1));
 		aEndpoint.set_open_handler(std::bind(&WebServerManager::handleSocketConnected<T>, aServer, &aEndpoint, _1, aIsSecure));
 
 		aEndpoint.set_open_handshake_timeout(HANDSHAKE_TIMEOUT);
-
-		aEndpoint.set_pong_timeout(WEBCFG(PING_TIMEOUT).num() * 1000);
-		aEndpoint.set_pong_timeout_handler(std::bind(&WebServerManager::handlePongTimeout, aServer, _1, _2));
-
-		// Workaround for https://github.com/zaphoyd/websocketpp/issues/549
-		aEndpoint.set_listen_backlog(boost::asio::socket_base::max_connections);
 	}
 
 	bool WebServerManager::startup(const ErrorF& errorF, const string& aWebResourcePath, const CallBack& aShutdownF) {
@@ -165,7 +168,6 @@ namespace webserver {
 		try {
 			// initialize asio with our external io_service rather than an internal one
 			endpoint_plain.init_asio(&ios);
-			endpoint_tls.init_asio(&ios);
 
 			//endpoint_plain.set_pong_handler(std::bind(&WebServerManager::onPongReceived, this, _1, _2));
 		} catch (const std::exception& e) {
@@ -176,12 +178,39 @@ namespace webserver {
 			return false;
 		}
 
+		// The TLS transport has no timers so upgraded TLS connections are closed by HttpConnection
+		// if nothing (not even a pong) is received after a ping
+		const HttpConnectionLimits limits{
+			HTTP_KEEP_ALIVE_TIMEOUT,
+			HTTP_MAX_KEEP_ALIVE_REQUESTS,
+			static_cast<time_t>(WEBCFG(PING_INTERVAL).num() + WEBCFG(PING_TIMEOUT).num())
+		};
+
+		plainListener = make_unique<HttpPlainListener>(
+			ios,
+			limits,
+			[this](const HttpPlainConnectionPtr& aConnection) {
+				handleHttpConnectionRequest(&endpoint_plain, aConnection, aConnection->getIp(), false);
+			},
+			std::bind(&WebServerManager::handlePlainUpgrade, this, _1)
+		);
+
+		tlsListener = make_unique<HttpTlsListener>(
+			ios,
+			limits,
+			[this](const HttpTlsConnectionPtr& aConnection) {
+				handleHttpConnectionRequest(&endpoint_tls, aConnection, aConnection->getIp(), true);
+			},
+			std::bind(&WebServerManager::handleTlsUpgrade, this, _1),
+			std::bind(&WebServerManager::getTlsContext, this)
+		);
+
 		// Handlers
 		setEndpointHandlers(endpoint_plain, false, this);
 		setEndpointHandlers(endpoint_tls, true, this);
 
-		// TLS endpoint has an extra handler for the tls init
-		endpoint_tls.set_tls_init_handler(std::bind(&WebServerManager::handleInitTls, this, _1));
+		endpoint_plain.set_pong_timeout(WEBCFG(PING_TIMEOUT).num() * 1000);
+		endpoint_plain.set_pong_timeout_handler(std::bind(&WebServerManager::handlePongTimeout, this, _1, _2));
 
 		// Logging
 		setEndpointLogSettings(endpoint_plain, debugStreamPlain);
@@ -190,36 +219,97 @@ namespace webserver {
 		return true;
 	}
 
+	void WebServerManager::handlePlainUpgrade(const HttpPlainConnectionPtr& aConnection) noexcept {
+		websocketpp::lib::error_code ec;
+		auto con = endpoint_plain.get_connection(ec);
+		if (!con) {
+			dcdebug("WebServerManager: failed to create a WebSocket connection (%s)\n", ec.message().c_str());
+			aConnection->close();
+			return;
+		}
+
+		aConnection->releaseSocket(con->get_raw_socket());
+		con->start();
+	}
+
+	void WebServerManager::handleTlsUpgrade(const HttpTlsConnectionPtr& aConnection) noexcept {
+		websocketpp::lib::error_code ec;
+		auto con = endpoint_tls.get_connection(ec);
+		if (!con) {
+			dcdebug("WebServerManager: failed to create a WebSocket connection (%s)\n", ec.message().c_str());
+			aConnection->close();
+			return;
+		}
+
+		// The websocketpp connection is owned by the TLS connection
+		std::weak_ptr<HttpTlsConnection> weakConnection(aConnection);
+
+		con->set_secure(true);
+		con->set_remote_endpoint(aConnection->getIp());
+		con->set_write_handler([weakConnection](websocketpp::connection_hdl, const char* aData, size_t aLen) {
+			auto connection = weakConnection.lock();
+			if (!connection) {
+				return websocketpp::transport::error::make_error_code(websocketpp::transport::error::eof);
+			}
+
+			connection->write(string(aData, aLen));
+			return websocketpp::lib::error_code();
+		});
+
+		con->set_shutdown_handler([weakConnection](websocketpp::connection_hdl) {
+			auto connection = weakConnection.lock();
+			if (connection) {
+				connection->close();
+			}
+
+			return websocketpp::lib::error_code();
+		});
+
+		con->transportBufferedAmountF = [weakConnection] {
+			auto connection = weakConnection.lock();
+			return connection ? connection->getBufferedAmount() : 0;
+		};
+
+		con->start();
+
+		aConnection->startTunnel({
+			[con](const char* aData, size_t aLen) {
+				con->read_all(aData, aLen);
+			},
+			[con] {
+				con->eof();
+			}
+		});
+	}
+
 	boost::asio::ip::tcp WebServerManager::getDefaultListenProtocol() noexcept {
 		auto v6Supported = !AirUtil::getLocalIp(true).empty();
 		return v6Supported ? boost::asio::ip::tcp::v6() : boost::asio::ip::tcp::v4();
 	}
 
 	bool WebServerManager::isListeningPlain() const noexcept {
-		return endpoint_plain.is_listening();
+		return plainListener && plainListener->isListening();
 	}
 
 	bool WebServerManager::isListeningTls() const noexcept {
-		return endpoint_tls.is_listening();
+		return tlsListener && tlsListener->isListening();
 	}
 
-	template <typename EndpointType>
-	bool listenEndpoint(EndpointType& aEndpoint, const ServerConfig& aConfig, const string& aProtocol, const WebServerManager::ErrorF& errorF) noexcept {
+	template <typename ListenF>
+	bool listenServer(const ServerConfig& aConfig, const string& aProtocol, const WebServerManager::ErrorF& errorF, const ListenF& aListenF) noexcept {
 		if (!aConfig.hasValidConfig()) {
 			return false;
 		}
 
-		aEndpoint.set_reuse_addr(true);
 		try {
 			const auto bindAddress = aConfig.bindAddress.str();
 			if (!bindAddress.empty()) {
-				aEndpoint.listen(bindAddress, aConfig.port.str());
+				aListenF(bindAddress, aConfig.port.str());
 			} else {
 				// IPv6 and IPv4-mapped IPv6 addresses are used by default (given that IPv6 is supported by the OS)
-				aEndpoint.listen(WebServerManager::getDefaultListenProtocol(), static_cast<uint16_t>(aConfig.port.num()));
+				aListenF(WebServerManager::getDefaultListenProtocol(), static_cast<uint16_t>(aConfig.port.num()));
 			}
 
-			aEndpoint.start_accept();
 			return true;
 		} catch (const std::exception& e) {
 			auto message = STRING_F(WEB_SERVER_SETUP_FAILED, aProtocol % aConfig.port.num() % string(e.what()));
@@ -234,11 +324,13 @@ namespace webserver {
 	bool WebServerManager::listen(const ErrorF& errorF) {
 		bool hasServer = false;
 
-		if (listenEndpoint(endpoint_plain, plainServerConfig, "HTTP", errorF)) {
+		// Connections are accepted by our own listeners so that HTTP connections can be kept alive
+		// (WebSocket connections are passed to the websocketpp endpoints)
+		if (listenServer(plainServerConfig, "HTTP", errorF, [this](const auto& aAddress, const auto& aPort) { plainListener->listen(aAddress, aPort); })) {
 			hasServer = true;
 		}
 
-		if (listenEndpoint(endpoint_tls, tlsServerConfig, "HTTPS", errorF)) {
+		if (listenServer(tlsServerConfig, "HTTPS", errorF, [this](const auto& aAddress, const auto& aPort) { tlsListener->listen(aAddress, aPort); })) {
 			hasServer = true;
 		}
 
@@ -258,12 +350,18 @@ namespace webserver {
 			task_threads->create_thread(boost::bind(&boost::asio::io_service::run, &tasks));
 		}
 
+		requestPool.start(WEBCFG(REQUEST_THREADS).num(), static_cast<size_t>(WEBCFG(REQUEST_QUEUE_LIMIT).num()));
+
 		// Add timers
 		{
 			const auto logger = getDefaultErrorLogger();
 			minuteTimer = addTimer(
 				[this, logger] {
 					save(logger);
+
+					if (isListeningTls()) {
+						checkTlsContext();
+					}
 				},
 				30 * 1000
 			);
@@ -275,8 +373,16 @@ namespace webserver {
 				WEBCFG(PING_INTERVAL).num() * 1000
 			);
 
+			eventFlushTimer = addTimer(
+				[this] {
+					flushSocketEvents();
+				},
+				EVENT_FLUSH_INTERVAL
+			);
+
 			minuteTimer->start(false);
 			socketPingTimer->start(false);
+			eventFlushTimer->start(false);
 		}
 
 		fire(WebServerManagerListener::Started());
@@ -347,9 +453,85 @@ namespace webserver {
 		}
 	}
 
-	context_ptr WebServerManager::handleInitTls(websocketpp::connection_hdl hdl) {
-		//std::cout << "on_tls_init called with hdl: " << hdl.lock().get() << std::endl;
+	WebServerManager::SocketStats WebServerManager::getSocketStats() const noexcept {
+		SocketStats stats = { 0, 0, 0, 0 };
+
+		RLock l(cs);
+		for (const auto& socket : sockets | map_values) {
+			stats.sockets++;
+			if (socket->isCongested()) {
+				stats.congestedSockets++;
+			}
+
+			stats.bufferedBytes += socket->getBufferedAmount();
+			stats.maxBufferedBytes = max(stats.maxBufferedBytes, socket->getMaxBufferedAmount());
+		}
+
+		return stats;
+	}
+
+	void WebServerManager::flushSocketEvents() noexcept {
+		RLock l(cs);
+		for (const auto& socket : sockets | map_values) {
+			socket->flushEvents();
+		}
+	}
+
+	context_ptr WebServerManager::getTlsContext() noexcept {
+		{
+			RLock l(tlsContextCS);
+			if (tlsContext) {
+				return tlsContext;
+			}
+		}
+
+		checkTlsContext();
+
+		RLock l(tlsContextCS);
+		return tlsContext;
+	}
+
+	WebServerManager::TlsFileInfo WebServerManager::getTlsFileInfo() noexcept {
+		const auto customCert = WEBCFG(TLS_CERT_PATH).str();
+		const auto customKey = WEBCFG(TLS_CERT_KEY_PATH).str();
+
+		bool useCustom = !customCert.empty() && !customKey.empty();
+
+		TlsFileInfo ret;
+		ret.certPath = useCustom ? customCert : SETTING(TLS_CERTIFICATE_FILE);
+		ret.keyPath = useCustom ? customKey : SETTING(TLS_PRIVATE_KEY_FILE);
+		ret.certModified = File::getLastModified(ret.certPath);
+		ret.keyModified = File::getLastModified(ret.keyPath);
+		return ret;
+	}
+
+	void WebServerManager::checkTlsContext() noexcept {
+		auto files = getTlsFileInfo();
+
+		{
+			RLock l(tlsContextCS);
+			if (tlsContext && files == tlsContextFiles) {
+				return;
+			}
+		}
+
+		context_ptr ctx;
+		auto loaded = createTlsContext(files, ctx);
+
+		WLock l(tlsContextCS);
+		if (!loaded && tlsContext) {
+			// The files may still be being written, keep using the old certificate and try again later
+			return;
+		}
+
+		// New connections will use the new context
+		tlsContext = ctx;
+		tlsContextFiles = files;
+	}
+
+	bool WebServerManager::createTlsContext(const TlsFileInfo& aFiles, context_ptr& ctx_) noexcept {
 		context_ptr ctx(new boost::asio::ssl::context(boost::asio::ssl::context::tls));
+		ctx_ = ctx;
 
 		try {
 			ctx->set_options(boost::asio::ssl::context::default_workarounds |
@@ -361,20 +543,27 @@ namespace webserver {
 				boost::asio::ssl::context::no_compression
 			);
 
-			const auto customCert = WEBCFG(TLS_CERT_PATH).str();
-			const auto customKey = WEBCFG(TLS_CERT_KEY_PATH).str();
-
-			bool useCustom = !customCert.empty() && !customKey.empty();
-
-			ctx->use_certificate_file(useCustom ? customCert : SETTING(TLS_CERTIFICATE_FILE), boost::asio::ssl::context::pem);
-			ctx->use_private_key_file(useCustom ? customKey : SETTING(TLS_PRIVATE_KEY_FILE), boost::asio::ssl::context::pem);
+			ctx->use_certificate_file(aFiles.certPath, boost::asio::ssl::context::pem);
+			ctx->use_private_key_file(aFiles.keyPath, boost::asio::ssl::context::pem);
 
 			CryptoManager::setContextOptions(ctx->native_handle(), true);
 		} catch (std::exception& e) {
 			dcdebug("TLS init failed: %s", e.what());
+			return false;
 		}
 
-		return ctx;
+		// Allow returning clients to resume their sessions (either with the session ID or a session ticket)
+		static const unsigned char sessionIdContext[] = "airdcpp-webserver";
+
+		auto nativeCtx = ctx->native_handle();
+		SSL_CTX_set_session_id_context(nativeCtx, sessionIdContext, sizeof(sessionIdContext) - 1);
+		SSL_CTX_set_session_cache_mode(nativeCtx, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(nativeCtx, TLS_SESSION_CACHE_SIZE);
+		SSL_CTX_set_timeout(nativeCtx, TLS_SESSION_TIMEOUT);
+		SSL_CTX_clear_options(nativeCtx, SSL_OP_NO_TICKET);
+
+		dcdebug("TLS context created (certificate %s)\n", aFiles.certPath.c_str());
+		return true;
 	}
 
 	void WebServerManager::disconnectSockets(const string& aMessage) noexcept {
@@ -391,16 +580,20 @@ namespace webserver {
 			minuteTimer->stop(true);
 		if (socketPingTimer)
 			socketPingTimer->stop(true);
+		if (eventFlushTimer)
+			eventFlushTimer->stop(true);
 
 		fire(WebServerManagerListener::Stopping());
 
-		if(endpoint_plain.is_listening())
-			endpoint_plain.stop_listening();
-		if(endpoint_tls.is_listening())
-			endpoint_tls.stop_listening();
+		if (plainListener)
+			plainListener->stop();
 
 		disconnectSockets("Shutting down");
 
+		// Upgraded TLS connections are closed after the close frames have been written
+		if (tlsListener)
+			tlsListener->stop();
+
 		bool hasSockets = false;
 
 		for (;;) {
@@ -416,6 +609,9 @@ namespace webserver {
 			}
 		}
 
+		// Responses of the queued requests are still written by the IO threads
+		requestPool.stop();
+
 		ios.stop();
 		tasks.stop();
 
@@ -428,6 +624,12 @@ namespace webserver {
 		task_threads.reset();
 		ios_threads.reset();
 
+		{
+			// The certificate will be reloaded when the server is started again
+			WLock l(tlsContextCS);
+			tlsContext = nullptr;
+		}
+
 		fire(WebServerManagerListener::Stopped());
 	}
 
@@ -543,6 +745,19 @@ namespace webserver {
 					}
 					xml.resetCurrentChild();
 
+					loadNumericSetting(xml, "ViewParallelThreshold", WEBCFG(VIEW_PARALLEL_THRESHOLD));
+					loadNumericSetting(xml, "WebSocketCompressionWindowBits", WEBCFG(WEBSOCKET_COMPRESSION_WINDOW_BITS));
+					loadNumericSetting(xml, "HttpCompressionThreshold", WEBCFG(HTTP_COMPRESSION_THRESHOLD));
+					loadNumericSetting(xml, "RequestThreads", WEBCFG(REQUEST_THREADS));
+					loadNumericSetting(xml, "RequestQueueLimit", WEBCFG(REQUEST_QUEUE_LIMIT));
+
+					if (xml.findChild("WebSocketCompressionContextTakeover")) {
+						xml.stepIn();
+						WEBCFG(WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER).setValue(Util::toInt(xml.getData()) > 0 ? true : false);
+						xml.stepOut();
+					}
+					xml.resetCurrentChild();
+
 					xml.stepOut();
 				}
 
@@ -609,6 +824,19 @@ namespace webserver {
 				xml.stepOut();
 			}
 
+			saveNumericSetting(xml, "ViewParallelThreshold", WEBCFG(VIEW_PARALLEL_THRESHOLD));
+			saveNumericSetting(xml, "WebSocketCompressionWindowBits", WEBCFG(WEBSOCKET_COMPRESSION_WINDOW_BITS));
+			saveNumericSetting(xml, "HttpCompressionThreshold", WEBCFG(HTTP_COMPRESSION_THRESHOLD));
+			saveNumericSetting(xml, "RequestThreads", WEBCFG(REQUEST_THREADS));
+			saveNumericSetting(xml, "RequestQueueLimit", WEBCFG(REQUEST_QUEUE_LIMIT));
+
+			if (!WEBCFG(WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER).isDefault()) {
+				xml.addTag("WebSocketCompressionContextTakeover");
+				xml.stepIn();
+				xml.setData(Util::toString(WEBCFG(WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER).boolean()));
+				xml.stepOut();
+			}
+
 			xml.stepOut();
 		}
 
@@ -625,6 +853,50 @@ namespace webserver {
 		return SettingsManager::saveSettingFile(xml, CONFIG_DIR, CONFIG_NAME, errorF);
 	}
 
+	void WebServerManager::loadNumericSetting(SimpleXML& aXml, const string& aTagName, ServerSettingItem& aSetting) noexcept {
+		if (aXml.findChild(aTagName)) {
+			aXml.stepIn();
+			aSetting.setValue(max(Util::toInt(aXml.getData()), aSetting.getMinMax().min));
+			aXml.stepOut();
+		}
+
+		aXml.resetCurrentChild();
+	}
+
+	void WebServerManager::saveNumericSetting(SimpleXML& aXml, const string& aTagName, const ServerSettingItem& aSetting) noexcept {
+		if (aSetting.isDefault()) {
+			return;
+		}
+
+		aXml.addTag(aTagName);
+		aXml.stepIn();
+		aXml.setData(Util::toString(aSetting.num()));
+		aXml.stepOut();
+	}
+
+	bool WebServerManager::compressHttpResponse(const websocketpp::http::parser::request& aRequest, const string& aData, string& compressed_) noexcept {
+		auto threshold = WEBCFG(HTTP_COMPRESSION_THRESHOLD).num();
+		if (threshold == 0 || aData.size() < static_cast<size_t>(threshold) || !HttpUtil::acceptsEncoding(aRequest, "gzip")) {
+			return false;
+		}
+
+		if (!HttpUtil::gzipCompress(aData, compressed_)) {
+			return false;
+		}
+
+		// Send the original data if it doesn't compress
+		return compressed_.size() < aData.size();
+	}
+
+	WebSocketDeflateOptions getWebSocketDeflateOptions() noexcept {
+		auto windowBits = WEBCFG(WEBSOCKET_COMPRESSION_WINDOW_BITS).num();
+		return {
+			// zlib doesn't support raw deflate streams with 8 bit windows
+			static_cast<uint8_t>(windowBits == 0 ? 0 : max(windowBits, 9)),
+			WEBCFG(WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER).boolean(),
+		};
+	}
+
 	bool ServerConfig::hasValidConfig() const noexcept {
 		return port.num() > 0;
 	}
@@ -25,7 +25,10 @@
 #include "FileServer.h"
 #include "ApiRequest.h"
 
+#include "HttpListener.h"
 #include "HttpUtil.h"
+#include "JsonWriter.h"
+#include "RequestPool.h"
 #include "SystemUtil.h"
 #include "Timer.h"
 #include "WebServerManagerListener.h"
@@ -67,9 +70,6 @@ namespace webserver {
 	using websocketpp::lib::placeholders::_2;
 	using websocketpp::lib::bind;
 
-	// type of the ssl context pointer is long so alias it
-	typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
-
 	class WebServerManager : public dcpp::Singleton<WebServerManager>, public Speaker<WebServerManagerListener> {
 	public:
 		TimerPtr addTimer(CallBack&& aCallBack, time_t aIntervalMillis, const Timer::CallbackWrapper& aCallbackWrapper = nullptr) noexcept;
@@ -89,6 +89,19 @@ namespace webserver {
 
 		void disconnectSockets(const std::string& aMessage) noexcept;
 
+		struct SocketStats {
+			size_t sockets;
+			size_t congestedSockets;
+
+			// Unsent bytes of all sockets
+			size_t bufferedBytes;
+
+			// Highest amount of unsent bytes of a single connected socket
+			size_t maxBufferedBytes;
+		};
+
+		SocketStats getSocketStats() const noexcept;
+
 		// Reset sessions for associated sockets
 		WebSocketPtr getSocket(LocalSessionId aSessionToken) noexcept;
 
@@ -137,11 +150,32 @@ namespace webserver {
 		void onData(const string& aData, TransportType aType, Direction aDirection, const string& aIP) noexcept;
 
 		// Websocketpp event handlers
+		template <typename EndpointType>
+		bool handleValidateSocket(EndpointType* aServer, websocketpp::connection_hdl hdl) {
+			auto con = aServer->get_con_from_hdl(hdl);
+
+			// Select the first supported subprotocol (old clients don't request any)
+			for (const auto& protocol: con->get_requested_subprotocols()) {
+				WebSocket::ProtocolOptions options;
+				if (WebSocket::parseProtocol(protocol, options)) {
+					con->select_subprotocol(protocol);
+					break;
+				}
+			}
+
+			return true;
+		}
+
 		template <typename EndpointType>
 		void handleSocketConnected(EndpointType* aServer, websocketpp::connection_hdl hdl, bool aIsSecure) {
 			auto con = aServer->get_con_from_hdl(hdl);
 			auto socket = make_shared<WebSocket>(aIsSecure, hdl, con->get_request(), aServer, this);
 
+			WebSocket::ProtocolOptions options;
+			if (WebSocket::parseProtocol(con->get_subprotocol(), options)) {
+				socket->setProtocolOptions(options);
+			}
+
 			addSocket(hdl, socket);
 		}
 
@@ -162,8 +196,13 @@ namespace webserver {
 				return;
 			}
 
-			onData(msg->get_payload(), TransportType::TYPE_SOCKET, Direction::INCOMING, socket->getIp());
-			api.handleSocketRequest(msg->get_payload(), socket, aIsSecure);
+			auto isBinary = msg->get_opcode() == websocketpp::frame::opcode::binary;
+			onData(
+				isBinary ? MessageEncoding::describe(socket->getEncoding(), msg->get_payload().size()) : msg->get_payload(),
+				TransportType::TYPE_SOCKET, Direction::INCOMING, socket->getIp()
+			);
+
+			api.handleSocketRequest(std::move(msg->get_raw_payload()), isBinary, socket, aIsSecure);
 		}
 
 
@@ -172,12 +211,43 @@ namespace webserver {
 			s->get_elog().write(aErrorLevel, aMessage);
 		}
 
-		template <typename EndpointType>
-		void handleHttpRequest(EndpointType* s, websocketpp::connection_hdl hdl, bool aIsSecure) {
-			// Blocking HTTP Handler
-			auto con = s->get_con_from_hdl(hdl);
-			auto ip = con->get_raw_socket().remote_endpoint().address().to_string();
+		static bool isApiRequest(const string& aResource) noexcept {
+			return aResource.length() >= 4 && aResource.compare(0, 4, "/api") == 0;
+		}
+
+		// HTTP handler for the persistent connections of both servers (see HttpConnection)
+		// API requests are handled in the request pool unless they are known to be cheap
+		template <typename EndpointType, typename ConnectionPtr>
+		void handleHttpConnectionRequest(EndpointType* s, const ConnectionPtr& con, const string& ip, bool aIsSecure) {
+			if (!isApiRequest(con->get_resource())) {
+				executeHttpRequest(s, con, ip, aIsSecure);
+				return;
+			}
+
+			if (ApiRouter::isInlineRequest(con->get_request().get_method(), con->get_resource())) {
+				requestPool.onRequestInlined();
+				executeHttpRequest(s, con, ip, aIsSecure);
+				return;
+			}
+
+			if (!requestPool.reserve()) {
+				con->set_body("Too many pending requests");
+				con->set_status(websocketpp::http::status_code::service_unavailable);
+				return;
+			}
+
+			con->defer_http_response();
+			requestPool.postReserved([=] {
+				if (!executeHttpRequest(s, con, ip, aIsSecure)) {
+					con->send_http_response();
+				}
+			});
+		}
 
+		// Blocking HTTP handler
+		// Returns true if the response was deferred by the request handler
+		template <typename EndpointType, typename ConnectionPtr>
+		bool executeHttpRequest(EndpointType* s, const ConnectionPtr& con, const string& ip, bool aIsSecure) {
 			SessionPtr session = nullptr;
 
 			auto authToken = HttpUtil::parseAuthToken(con->get_request());
@@ -187,20 +257,36 @@ namespace webserver {
 				} catch (const std::exception& e) {
 					con->set_body(e.what());
 					con->set_status(websocketpp::http::status_code::unauthorized);
-					return;
+					return false;
 				}
 			}
 
-			if (con->get_resource().length() >= 4 && con->get_resource().compare(0, 4, "/api") == 0) {
+			if (isApiRequest(con->get_resource())) {
 				onData(con->get_resource() + ": " + con->get_request().get_body(), TransportType::TYPE_HTTP_API, Direction::INCOMING, ip);
 
 
-				const auto responseF = [this, s, con, ip](websocketpp::http::status_code::value aStatus, const json& aResponseJsonData, const json& aResponseErrorJson) {
+				const auto sendDataF = [this, con, ip](websocketpp::http::status_code::value aStatus, const string& aData) {
+					onData(con->get_resource() + " (" + Util::toString(aStatus) + "): " + aData, TransportType::TYPE_HTTP_API, Direction::OUTGOING, ip);
+
+					string compressed;
+					if (compressHttpResponse(con->get_request(), aData, compressed)) {
+						con->set_body(compressed);
+						con->append_header("Content-Encoding", "gzip");
+					} else {
+						con->set_body(aData);
+					}
+
+					con->append_header("Vary", "Accept-Encoding");
+					con->append_header("Content-Type", "application/json");
+					con->set_status(aStatus);
+				};
+
+				const auto responseF = [this, s, con, sendDataF](websocketpp::http::status_code::value aStatus, const json& aResponseJsonData, const json& aResponseErrorJson) {
 					string data;
 					const auto& responseJson = !aResponseErrorJson.is_null() ? aResponseErrorJson : aResponseJsonData;
 					if (!responseJson.is_null()) {
 						try {
-							data = responseJson.dump();
+							data = JsonWriter::dump(responseJson);
 						} catch (const std::exception & e) {
 							logDebugError(s, "Failed to convert data to JSON: " + string(e.what()), websocketpp::log::elevel::fatal);
 
@@ -210,12 +296,7 @@ namespace webserver {
 						}
 					}
 
-					onData(con->get_resource() + " (" + Util::toString(aStatus) + "): " + data, TransportType::TYPE_HTTP_API, Direction::OUTGOING, ip);
-
-					con->set_body(data);
-					con->append_header("Content-Type", "application/json");
-					con->append_header("Connection", "close"); // Workaround for https://github.com/zaphoyd/websocketpp/issues/890
-					con->set_status(aStatus);
+					sendDataF(aStatus, data);
 				};
 
 
@@ -231,10 +312,12 @@ namespace webserver {
 				};
 
 				json output, apiError;
+				string serializedOutput;
 				auto status = api.handleHttpRequest(
 					con->get_resource(),
 					con->get_request(),
 					output,
+					serializedOutput,
 					apiError,
 					aIsSecure,
 					ip,
@@ -243,8 +326,14 @@ namespace webserver {
 				);
 
 				if (!isDeferred) {
-					responseF(status, output, apiError);
+					if (!serializedOutput.empty() && apiError.is_null()) {
+						sendDataF(status, serializedOutput);
+					} else {
+						responseF(status, output, apiError);
+					}
 				}
+
+				return isDeferred;
 			} else {
 				onData(con->get_request().get_method() + " " + con->get_resource(), TransportType::TYPE_HTTP_FILE, Direction::INCOMING, ip);
 
@@ -260,8 +349,6 @@ namespace webserver {
 						ip
 					);
 
-					con->append_header("Connection", "close"); // Workaround for https://github.com/zaphoyd/websocketpp/issues/890
-
 					if (HttpUtil::isStatusOk(aStatus)) {
 						// Don't set any incomplete/invalid headers in case of errors...
 						for (const auto& p : aHeaders) {
@@ -291,9 +378,15 @@ namespace webserver {
 				if (!isDeferred) {
 					responseF(status, output, headers);
 				}
+
+				return isDeferred;
 			}
 		}
 
+		// Compresses API responses that exceed the configured size threshold if the client supports gzip
+		// Returns false if the data should be sent uncompressed
+		bool compressHttpResponse(const websocketpp::http::parser::request& aRequest, const string& aData, string& compressed_) noexcept;
+
 		void log(const string& aMsg, LogMessage::Severity aSeverity) const noexcept;
 		ErrorF getDefaultErrorLogger() const noexcept;
 
@@ -306,10 +399,44 @@ namespace webserver {
 		const FileServer& getFileServer() const noexcept {
 			return fileServer;
 		}
+
+		RequestPool& getRequestPool() noexcept {
+			return requestPool;
+		}
 	private:
 		WebServerSettings settings;
 
-		context_ptr handleInitTls(websocketpp::connection_hdl hdl);
+		// Pass a plain WebSocket connection accepted by the HTTP listener to websocketpp
+		void handlePlainUpgrade(const HttpPlainConnectionPtr& aConnection) noexcept;
+
+		// Create a websocketpp connection for an upgraded TLS connection
+		// The TLS connection passes the data between the stream and websocketpp
+		void handleTlsUpgrade(const HttpTlsConnectionPtr& aConnection) noexcept;
+
+		struct TlsFileInfo {
+			string certPath;
+			string keyPath;
+			time_t certModified = 0;
+			time_t keyModified = 0;
+
+			bool operator==(const TlsFileInfo& aOther) const noexcept {
+				return certPath == aOther.certPath && keyPath == aOther.keyPath && certModified == aOther.certModified && keyModified == aOther.keyModified;
+			}
+		};
+
+		static TlsFileInfo getTlsFileInfo() noexcept;
+
+		// Returns false if the certificate couldn't be loaded
+		static bool createTlsContext(const TlsFileInfo& aFiles, context_ptr& ctx_) noexcept;
+
+		// The same context is shared by all connections so that the certificate files are only loaded once
+		// and the TLS sessions can be resumed (the session cache and ticket keys are stored in the context)
+		context_ptr getTlsContext() noexcept;
+
+		// Recreate the shared context if the certificate files or their paths have changed
+		void checkTlsContext() noexcept;
+
+		void flushSocketEvents() noexcept;
 
 		void addSocket(websocketpp::connection_hdl hdl, const WebSocketPtr& aSocket) noexcept;
 		WebSocketPtr getSocket(websocketpp::connection_hdl hdl) const noexcept;
@@ -321,6 +448,9 @@ namespace webserver {
 		ServerConfig tlsServerConfig;
 
 		void loadServer(SimpleXML& xml_, const string& aTagName, ServerConfig& config_, bool aTls) noexcept;
+
+		static void loadNumericSetting(SimpleXML& aXml, const string& aTagName, ServerSettingItem& aSetting) noexcept;
+		static void saveNumericSetting(SimpleXML& aXml, const string& aTagName, const ServerSettingItem& aSetting) noexcept;
 		void pingTimer() noexcept;
 
 		mutable SharedMutex cs;
@@ -336,6 +466,7 @@ namespace webserver {
 		std::map<websocketpp::connection_hdl, WebSocketPtr, std::owner_less<websocketpp::connection_hdl>> sockets;
 
 		ApiRouter api;
+		RequestPool requestPool;
 		FileServer fileServer;
 
 		unique_ptr<WebUserManager> userManager;
@@ -344,7 +475,14 @@ namespace webserver {
 
 		TimerPtr minuteTimer;
 		TimerPtr socketPingTimer;
+		TimerPtr eventFlushTimer;
+
+		context_ptr tlsContext;
+		TlsFileInfo tlsContextFiles;
+		mutable SharedMutex tlsContextCS;
 
+		unique_ptr<HttpPlainListener> plainListener;
+		unique_ptr<HttpTlsListener> tlsListener;
 		server_plain endpoint_plain;
 		server_tls endpoint_tls;
 
@@ -41,5 +41,14 @@ namespace webserver {
 			{ "ping_timeout", ResourceManager::WEB_CFG_PING_TIMEOUT, 10, ApiSettingItem::TYPE_NUMBER, false, { 1, 10000 }, ResourceManager::SECONDS_LOWER },
 
 			{ "extensions_debug_mode", ResourceManager::WEB_CFG_EXTENSIONS_DEBUG_MODE, false, ApiSettingItem::TYPE_BOOLEAN, false },
+
+			{ "web_view_parallel_threshold", ResourceManager::WEB_CFG_VIEW_PARALLEL_THRESHOLD, 50000, ApiSettingItem::TYPE_NUMBER, false, { 0, MAX_INT_VALUE } },
+
+			{ "web_websocket_compression_window_bits", ResourceManager::WEB_CFG_WEBSOCKET_COMPRESSION_WINDOW_BITS, 15, ApiSettingItem::TYPE_NUMBER, false, { 0, 15 } },
+			{ "web_websocket_compression_context_takeover", ResourceManager::WEB_CFG_WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER, true, ApiSettingItem::TYPE_BOOLEAN, false },
+			{ "web_http_compression_threshold", ResourceManager::WEB_CFG_HTTP_COMPRESSION_THRESHOLD, 1024, ApiSettingItem::TYPE_NUMBER, false, { 0, MAX_INT_VALUE } },
+
+			{ "web_request_threads", ResourceManager::WEB_CFG_REQUEST_THREADS, 4, ApiSettingItem::TYPE_NUMBER, false, { 1, 100 } },
+			{ "web_request_queue_limit", ResourceManager::WEB_CFG_REQUEST_QUEUE_LIMIT, 1000, ApiSettingItem::TYPE_NUMBER, false, { 0, MAX_INT_VALUE } },
 		}) {}
 }
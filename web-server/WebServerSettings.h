@@ -45,6 +45,15 @@ namespace webserver {
 			PING_TIMEOUT,
 
 			EXTENSIONS_DEBUG_MODE,
+
+			VIEW_PARALLEL_THRESHOLD,
+
+			WEBSOCKET_COMPRESSION_WINDOW_BITS,
+			WEBSOCKET_COMPRESSION_CONTEXT_TAKEOVER,
+			HTTP_COMPRESSION_THRESHOLD,
+
+			REQUEST_THREADS,
+			REQUEST_QUEUE_LIMIT,
 		};
 
 		ServerSettingItem& getValue(ServerSettings aSetting) noexcept {
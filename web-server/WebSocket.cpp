@@ -19,7 +19,9 @@
 #include "stdinc.h"
 
 #include <web-server/HttpUtil.h>
+#include <web-server/JsonScanner.h>
 #include <web-server/JsonUtil.h>
+#include <web-server/JsonWriter.h>
 #include <web-server/WebServerManager.h>
 #include <web-server/WebSocket.h>
 
@@ -27,8 +29,32 @@
 #include <airdcpp/TimerManager.h>
 #include <airdcpp/Util.h>
 
+#include <atomic>
+
+// Unsent data after which the socket is considered to be congested
+#define SEND_BUFFER_HIGH_WATERMARK 1024*1024
+
+// Congestion ends once the buffered data has drained below this
+#define SEND_BUFFER_LOW_WATERMARK 256*1024
+
+// Close the socket if the client is unable to keep up even with the coalesced events
+#define SEND_BUFFER_HARD_LIMIT 32*1024*1024
 
 namespace webserver {
+	namespace {
+		std::atomic<uint64_t> totalCongestions { 0 };
+		std::atomic<uint64_t> totalOverflowCloses { 0 };
+		std::atomic<uint64_t> totalSupersededEvents { 0 };
+	}
+
+	WebSocket::DeliveryStats WebSocket::getDeliveryStats() noexcept {
+		return {
+			totalCongestions.load(),
+			totalOverflowCloses.load(),
+			totalSupersededEvents.load(),
+		};
+	}
+
 	WebSocket::WebSocket(bool aIsSecure, websocketpp::connection_hdl aHdl, const websocketpp::http::parser::request& aRequest, server_plain* aServer, WebServerManager* aWsm) : WebSocket(aIsSecure, aHdl, aRequest, aWsm) {
 		plainServer = aServer;
 	}
@@ -38,7 +64,7 @@ namespace webserver {
 	}
 
 	WebSocket::WebSocket(bool aIsSecure, websocketpp::connection_hdl aHdl, const websocketpp::http::parser::request& aRequest, WebServerManager* aWsm) :
-		secure(aIsSecure), hdl(aHdl), timeCreated(GET_TICK()), wsm(aWsm) {
+		secure(aIsSecure), hdl(aHdl), timeCreated(GET_TICK()), wsm(aWsm), requestStrand(aWsm->getRequestPool().getService()) {
 
 		debugMessage("Websocket created");
 
@@ -55,8 +81,9 @@ namespace webserver {
 	string WebSocket::getIp() const noexcept {
 		try {
 			if (secure) {
+				// Set by the TLS connection
 				auto conn = tlsServer->get_con_from_hdl(hdl);
-				return conn->get_raw_socket().remote_endpoint().address().to_string();
+				return conn->get_remote_endpoint();
 			} else {
 				auto conn = plainServer->get_con_from_hdl(hdl);
 				return conn->get_raw_socket().remote_endpoint().address().to_string();
@@ -68,6 +95,30 @@ namespace webserver {
 		return Util::emptyString;
 	}
 
+	bool WebSocket::dispatchRequest(CallBack&& aTask, bool aAllowInline) noexcept {
+		auto& pool = wsm->getRequestPool();
+
+		// Messages of a socket are received one at a time so no requests can be queued meanwhile
+		if (aAllowInline && pendingRequests == 0) {
+			pool.onRequestInlined();
+			aTask();
+			return true;
+		}
+
+		pendingRequests++;
+		auto queued = pool.post(requestStrand, [this, task = std::move(aTask)] {
+			// The task holds a reference to the socket
+			task();
+			pendingRequests--;
+		});
+
+		if (!queued) {
+			pendingRequests--;
+		}
+
+		return queued;
+	}
+
 	void WebSocket::sendApiResponse(const json& aResponseJson, const json& aErrorJson, websocketpp::http::status_code::value aCode, int aCallbackId) noexcept {
 		json j;
 
@@ -103,6 +154,22 @@ namespace webserver {
 		}
 	}
 
+	void WebSocket::sendApiResponse(const string& aSerializedData, websocketpp::http::status_code::value aCode, int aCallbackId) noexcept {
+		dcassert(aCallbackId > 0 && HttpUtil::isStatusOk(aCode));
+
+		JsonWriter writer(aSerializedData.size() + 50);
+		writer.startObject();
+		writer.writeKey("callback_id");
+		writer.writeInteger(aCallbackId);
+		writer.writeKey("code");
+		writer.writeInteger(aCode);
+		writer.writeKey("data");
+		writer.writeRaw(aSerializedData);
+		writer.endObject();
+
+		sendPlain(writer.str());
+	}
+
 	void WebSocket::logError(const string& aMessage, websocketpp::log::level aErrorLevel) const noexcept {
 		auto message = (dcpp_fmt("Websocket: " + aMessage + " (%s)") % (session ? session->getAuthToken().c_str() : "no session")).str();
 		if (secure) {
@@ -117,25 +184,218 @@ namespace webserver {
 	}
 
 	void WebSocket::sendPlain(const json& aJson) {
-		string str;
+		auto type = encoding.load();
+
+		string data;
 		try {
-			str = aJson.dump();
+			data = MessageEncoding::encode(type, aJson);
 		} catch (const std::exception& e) {
 			logError("Failed to convert data to JSON: " + string(e.what()), websocketpp::log::elevel::fatal);
 			throw e;
 		}
 
-		wsm->onData(str, TransportType::TYPE_SOCKET, Direction::OUTGOING, getIp());
+		if (MessageEncoding::isBinary(type)) {
+			// Don't serialize the JSON text only for debug output
+			sendOrdered(MessageEncoding::describe(type, data.size()), data, type);
+		} else {
+			sendOrdered(data, data, type);
+		}
+	}
+
+	void WebSocket::sendPlain(const string& aText) noexcept {
+		auto type = encoding.load();
+		if (!MessageEncoding::isBinary(type)) {
+			sendOrdered(aText, aText, type);
+			return;
+		}
+
+		string data;
+		try {
+			data = MessageEncoding::fromJsonText(type, aText);
+		} catch (const std::exception& e) {
+			logError("Failed to encode the message: " + string(e.what()), websocketpp::log::elevel::fatal);
+			return;
+		}
+
+		sendOrdered(aText, data, type);
+	}
+
+	void WebSocket::sendOrdered(const string& aText, const string& aData, MessageEncoding::Type aEncoding) noexcept {
+		if (!protocolOptions.eventBatching && !congested) {
+			sendEncoded(aText, aData, aEncoding);
+			return;
+		}
+
+		// Keep the original order also while the socket is congested (responses can't be delayed and the client
+		// must not receive older queued updates after the response)
+		// The flushed events still count towards the send buffer limit
+		Lock l(eventCS);
+		flushEventsUnsafe();
+		sendEncoded(aText, aData, aEncoding);
+	}
 
+	void WebSocket::sendEvent(const MessageFramePtr& aMessage) noexcept {
+		if (overflowed) {
+			// Closing
+			return;
+		}
+
+		// Events are queued only while the socket is congested unless batching is used
+		// (congestion is cleared after the queue has been flushed so an empty queue can be bypassed safely)
+		if (!protocolOptions.eventBatching && !congested) {
+			sendEventDirect(aMessage);
+			return;
+		}
+
+		Lock l(eventCS);
+		if (!protocolOptions.eventBatching && !congested) {
+			// Flushed meanwhile
+			sendEventDirect(aMessage);
+			return;
+		}
+
+		auto superseded = eventQueue.getSupersededCount();
+		eventQueue.add(aMessage, congested);
+		totalSupersededEvents += eventQueue.getSupersededCount() - superseded;
+
+		if (congested) {
+			// Only the state events can be superseded, the rest count towards the send buffer limit
+			checkSendLimit(getBufferedAmount() + eventQueue.getBytes());
+		} else if (eventQueue.full()) {
+			flushEventsUnsafe();
+		}
+	}
+
+	void WebSocket::sendEventDirect(const MessageFramePtr& aMessage) noexcept {
+		auto type = encoding.load();
+		try {
+			sendEncoded(aMessage->getText(), aMessage->getEncoded(type), type);
+		} catch (const std::exception& e) {
+			logError("Failed to encode the event: " + string(e.what()), websocketpp::log::elevel::fatal);
+		}
+	}
+
+	void WebSocket::flushEvents() noexcept {
+		if (!protocolOptions.eventBatching && !congested) {
+			return;
+		}
+
+		Lock l(eventCS);
+		if (!congested) {
+			flushEventsUnsafe();
+			return;
+		}
+
+		if (getBufferedAmount() >= SEND_BUFFER_LOW_WATERMARK) {
+			return;
+		}
+
+		// The congestion can't be cleared before the queued events have been sent
+		flushEventsUnsafe();
+		if (getBufferedAmount() < SEND_BUFFER_HIGH_WATERMARK) {
+			debugMessage("Websocket send buffer drained");
+			congested = false;
+		}
+	}
+
+	void WebSocket::flushEventsUnsafe() noexcept {
+		if (eventQueue.empty()) {
+			return;
+		}
+
+		auto type = encoding.load();
+		if (protocolOptions.eventBatching) {
+			string data;
+			try {
+				data = MessageFrame::encodeArray(type, eventQueue.take());
+			} catch (const std::exception& e) {
+				logError("Failed to encode the events: " + string(e.what()), websocketpp::log::elevel::fatal);
+				return;
+			}
+
+			sendEncoded(MessageEncoding::isBinary(type) ? MessageEncoding::describe(type, data.size()) : data, data, type);
+			return;
+		}
+
+		// Events were queued only because of congestion
+		for (const auto& message: eventQueue.take()) {
+			try {
+				sendEncoded(message->getText(), message->getEncoded(type), type);
+			} catch (const std::exception& e) {
+				logError("Failed to encode the event: " + string(e.what()), websocketpp::log::elevel::fatal);
+			}
+		}
+	}
+
+	size_t WebSocket::getBufferedAmount() const noexcept {
 		try {
 			if (secure) {
-				tlsServer->send(hdl, str, websocketpp::frame::opcode::text);
+				// Data that websocketpp has passed on may still be queued for the TLS stream
+				auto conn = tlsServer->get_con_from_hdl(hdl);
+				return conn->get_buffered_amount() + conn->transportBufferedAmountF();
 			} else {
-				plainServer->send(hdl, str, websocketpp::frame::opcode::text);
+				return plainServer->get_con_from_hdl(hdl)->get_buffered_amount();
+			}
+		} catch (const std::exception&) {
+			// Disconnected
+		}
+
+		return 0;
+	}
+
+	bool WebSocket::checkSendLimit(size_t aUnsentBytes) noexcept {
+		if (aUnsentBytes < SEND_BUFFER_HARD_LIMIT) {
+			return true;
+		}
+
+		if (!overflowed.exchange(true)) {
+			totalOverflowCloses++;
+			logError("Send buffer limit exceeded (" + Util::toString(aUnsentBytes) + " bytes unsent), closing the socket", websocketpp::log::elevel::warn);
+			close(websocketpp::close::status::try_again_later, "Send buffer limit exceeded");
+		}
+
+		return false;
+	}
+
+	void WebSocket::checkBufferedAmount() noexcept {
+		auto buffered = getBufferedAmount();
+
+		// Racy but good enough for statistics
+		if (buffered > maxBufferedAmount.load()) {
+			maxBufferedAmount.store(buffered);
+		}
+
+		if (!checkSendLimit(buffered)) {
+			return;
+		}
+
+		if (buffered >= SEND_BUFFER_HIGH_WATERMARK && !congested.exchange(true)) {
+			totalCongestions++;
+			debugMessage("Websocket send buffer congested (" + Util::toString(buffered) + " bytes unsent)");
+		}
+	}
+
+	void WebSocket::sendEncoded(const string& aText, const string& aData, MessageEncoding::Type aEncoding) noexcept {
+		if (overflowed) {
+			// Closing
+			return;
+		}
+
+		wsm->onData(aText, TransportType::TYPE_SOCKET, Direction::OUTGOING, getIp());
+
+		auto opCode = MessageEncoding::isBinary(aEncoding) ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+		try {
+			if (secure) {
+				tlsServer->send(hdl, aData, opCode);
+			} else {
+				plainServer->send(hdl, aData, opCode);
 			}
 		} catch (const std::exception& e) {
 			logError("Failed to send data: " + string(e.what()), websocketpp::log::elevel::fatal);
+			return;
 		}
+
+		checkBufferedAmount();
 	}
 
 	void WebSocket::ping() noexcept {
@@ -172,12 +432,56 @@ namespace webserver {
 		}
 	}
 
-	void WebSocket::parseRequest(const string& aRequest, int& callbackId_, string& method_, string& path_, json& data_) {
-		const auto requestJson = json::parse(aRequest);
+	bool WebSocket::parseProtocol(const string& aProtocol, ProtocolOptions& options_) noexcept {
+		StringTokenizer<string> tokens(aProtocol, '.');
+		if (tokens.getTokens().empty() || tokens.getTokens().front() != "airdcpp") {
+			return false;
+		}
+
+		ProtocolOptions options;
+		for (auto i = tokens.getTokens().begin() + 1; i != tokens.getTokens().end(); ++i) {
+			if (*i == "batch") {
+				options.eventBatching = true;
+			} else if (MessageEncoding::parse(*i, options.encoding)) {
+				// Encoding
+			} else {
+				return false;
+			}
+		}
+
+		options_ = options;
+		return true;
+	}
+
+	void WebSocket::parseRequest(const string& aRequest, int& callbackId_, string& method_, string& path_, JsonRange& data_) {
+		// Parse the small header fields only
+		json requestJson = json::object();
+		JsonScanner::forEachField(aRequest, [&](const string& aKey, const JsonRange& aValue) {
+			if (aKey == "data") {
+				data_ = aValue;
+			} else if (aKey == "callback_id" || aKey == "path" || aKey == "method") {
+				requestJson[aKey] = aValue.parse();
+			}
+		});
+
+		callbackId_ = JsonUtil::getOptionalFieldDefault<int>("callback_id", requestJson, -1);
+		path_ = requestJson.at("path");
+		method_ = requestJson.at("method");
+	}
+
+	void WebSocket::parseRequest(MessageEncoding::Type aEncoding, const string& aRequest, int& callbackId_, string& method_, string& path_, json& data_) {
+		auto requestJson = MessageEncoding::decode(aEncoding, aRequest);
+		if (!requestJson.is_object()) {
+			throw std::invalid_argument("Request must be an object");
+		}
 
 		callbackId_ = JsonUtil::getOptionalFieldDefault<int>("callback_id", requestJson, -1);
 		path_ = requestJson.at("path");
-		data_ = JsonUtil::getOptionalRawField("data", requestJson);
 		method_ = requestJson.at("method");
+
+		auto data = requestJson.find("data");
+		if (data != requestJson.end()) {
+			data_ = std::move(*data);
+		}
 	}
-}
\ No newline at end of file
+}
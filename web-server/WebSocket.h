@@ -23,7 +23,11 @@
 
 #include <web-server/Session.h>
 #include <web-server/ApiRequest.h>
+#include <web-server/EventQueue.h>
+#include <web-server/MessageEncoding.h>
+#include <web-server/RequestPool.h>
 
+#include <airdcpp/CriticalSection.h>
 #include <airdcpp/GetSet.h>
 
 namespace webserver {
@@ -31,6 +35,33 @@ namespace webserver {
 
 	class WebSocket {
 	public:
+		// Optional features that the client may request with the subprotocol of the handshake
+		struct ProtocolOptions {
+			// Events are queued and sent as JSON arrays (updates of the same entity are merged)
+			bool eventBatching = false;
+
+			// Wire format of requests, responses and events
+			MessageEncoding::Type encoding = MessageEncoding::TYPE_JSON;
+		};
+
+		// Totals of all sockets
+		struct DeliveryStats {
+			// Times that a socket has exceeded the high watermark of the send buffer
+			uint64_t congestions;
+
+			// Sockets that were closed because the send buffer limit was exceeded
+			uint64_t overflowCloses;
+
+			// State events that were merged into a queued event while the socket was congested
+			uint64_t supersededEvents;
+		};
+
+		static DeliveryStats getDeliveryStats() noexcept;
+
+		// Subprotocol format: airdcpp[.option]... (e.g. airdcpp.batch.cbor)
+		// Returns false if the subprotocol or any of the options isn't supported
+		static bool parseProtocol(const string& aProtocol, ProtocolOptions& options_) noexcept;
+
 		WebSocket(bool aIsSecure, websocketpp::connection_hdl aHdl, const websocketpp::http::parser::request& aRequest, server_plain* aServer, WebServerManager* aWsm);
 		WebSocket(bool aIsSecure, websocketpp::connection_hdl aHdl, const websocketpp::http::parser::request& aRequest, server_tls* aServer, WebServerManager* aWsm);
 		~WebSocket();
@@ -46,8 +77,63 @@ namespace webserver {
 		// NMDC code can't be trusted to parse the incoming messages without incorrectly 
 		// splitting multibyte character sequences in malformed received data...
 		void sendPlain(const json& aJson);
+
+		// Send JSON text that has been serialized already (it's converted to the socket encoding)
+		// Queued events are flushed first so that the messages are received in the original order
+		void sendPlain(const string& aText) noexcept;
+
+		// Send an event message that may be shared with other sockets
+		// The event is sent immediately unless event batching has been enabled for the socket or the socket is congested
+		//
+		// The socket is congested after the amount of unsent data has exceeded the high watermark. Events are queued
+		// until the data has been drained below the low watermark and newer state events (list view updates and statistics)
+		// supersede the queued ones. API responses are still sent immediately, after the queued events so that
+		// the client won't receive older updates after them. The socket is closed if the client doesn't read the data at all.
+		void sendEvent(const MessageFramePtr& aMessage) noexcept;
+
+		// Send all queued events (called periodically by the web server)
+		void flushEvents() noexcept;
+
+		// Bytes that have been queued for sending but haven't been written to the network yet
+		size_t getBufferedAmount() const noexcept;
+
+		size_t getMaxBufferedAmount() const noexcept {
+			return maxBufferedAmount;
+		}
+
+		bool isCongested() const noexcept {
+			return congested;
+		}
+
+		void setProtocolOptions(const ProtocolOptions& aOptions) noexcept {
+			protocolOptions = aOptions;
+			encoding = aOptions.encoding;
+		}
+
+		const ProtocolOptions& getProtocolOptions() const noexcept {
+			return protocolOptions;
+		}
+
+		// The encoding may also be changed after connecting (the new encoding is used for all following messages)
+		void setEncoding(MessageEncoding::Type aEncoding) noexcept {
+			encoding = aEncoding;
+		}
+
+		MessageEncoding::Type getEncoding() const noexcept {
+			return encoding;
+		}
+
+		// Handle an API request of the socket in the request pool
+		// Requests are handled one at a time in the order in which they were received. Use aAllowInline for cheap
+		// requests that may be handled in the calling thread if there are no earlier requests waiting.
+		// Returns false if the request queue is full.
+		bool dispatchRequest(CallBack&& aTask, bool aAllowInline) noexcept;
+
 		void sendApiResponse(const json& aJsonResponse, const json& aErrorJson, websocketpp::http::status_code::value aCode, int aCallbackId) noexcept;
 
+		// Send a successful response with data that has been serialized already
+		void sendApiResponse(const string& aSerializedData, websocketpp::http::status_code::value aCode, int aCallbackId) noexcept;
+
 		WebSocket(WebSocket&) = delete;
 		WebSocket& operator=(WebSocket&) = delete;
 
@@ -66,10 +152,32 @@ namespace webserver {
 		}
 
 		const websocketpp::http::parser::request& getRequest() noexcept;
-		static void parseRequest(const string& aRequest, int& callbackId_, string& method_, string& path_, json& data_);
+		// The data is returned unparsed (it refers to the request string)
+		static void parseRequest(const string& aRequest, int& callbackId_, string& method_, string& path_, JsonRange& data_);
+
+		// Parse a request in a binary encoding
+		static void parseRequest(MessageEncoding::Type aEncoding, const string& aRequest, int& callbackId_, string& method_, string& path_, json& data_);
 	protected:
 		WebSocket(bool aIsSecure, websocketpp::connection_hdl aHdl, const websocketpp::http::parser::request& aRequest, WebServerManager* aWsm);
 	private:
+		// Send a message that isn't an event after the queued events
+		void sendOrdered(const string& aText, const string& aData, MessageEncoding::Type aEncoding) noexcept;
+
+		// Send data that is in the wanted encoding already (the JSON text or description is used for debug output)
+		void sendEncoded(const string& aText, const string& aData, MessageEncoding::Type aEncoding) noexcept;
+
+		// Event lock must be held
+		void flushEventsUnsafe() noexcept;
+
+		// Update the congestion state after sending data
+		void checkBufferedAmount() noexcept;
+
+		// Closes the socket if there is too much unsent data
+		// Returns false if the socket is being closed
+		bool checkSendLimit(size_t aUnsentBytes) noexcept;
+
+		void sendEventDirect(const MessageFramePtr& aMessage) noexcept;
+
 		const union {
 			server_plain* plainServer;
 			server_tls* tlsServer;
@@ -80,6 +188,21 @@ namespace webserver {
 		const bool secure;
 		const time_t timeCreated;
 		string url;
+
+		ProtocolOptions protocolOptions;
+		std::atomic<MessageEncoding::Type> encoding { MessageEncoding::TYPE_JSON };
+
+		EventQueue eventQueue;
+		CriticalSection eventCS;
+
+		std::atomic<bool> congested { false };
+		std::atomic<bool> overflowed { false };
+		std::atomic<size_t> maxBufferedAmount { 0 };
+
+		RequestPool::Strand requestStrand;
+
+		// Requests posted to the strand that haven't been completed yet
+		std::atomic<int> pendingRequests { 0 };
 	};
 }
 
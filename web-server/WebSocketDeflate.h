@@ -0,0 +1,93 @@
+/*
+* Copyright (C) 2011-2019 AirDC++ Project
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef DCPLUSPLUS_DCPP_WEBSOCKET_DEFLATE_H
+#define DCPLUSPLUS_DCPP_WEBSOCKET_DEFLATE_H
+
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/config/core.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+
+
+namespace webserver {
+	struct WebSocketDeflateOptions {
+		// Maximum LZ77 window size used for compressing outgoing messages (9-15, 0 = compression disabled)
+		uint8_t maxWindowBits;
+
+		// Keep the compression context between messages (better compression ratio but uses more memory per socket)
+		bool contextTakeover;
+	};
+
+	// Options for new connections (from the current web server settings)
+	WebSocketDeflateOptions getWebSocketDeflateOptions() noexcept;
+
+	// permessage-deflate extension (RFC 7692) that is configured from the web server settings
+	// A new instance is created for each connection
+	template <typename config>
+	class WebSocketDeflate : public websocketpp::extensions::permessage_deflate::enabled<config> {
+		typedef websocketpp::extensions::permessage_deflate::enabled<config> base;
+	public:
+		WebSocketDeflate() : options(getWebSocketDeflateOptions()) {
+			if (options.maxWindowBits > 0) {
+				// The client is always allowed to request a smaller window
+				base::set_server_max_window_bits(options.maxWindowBits, websocketpp::extensions::permessage_deflate::mode::smallest);
+			}
+
+			if (!options.contextTakeover) {
+				base::enable_server_no_context_takeover();
+				base::enable_client_no_context_takeover();
+			}
+		}
+
+		websocketpp::err_str_pair negotiate(websocketpp::http::attribute_list const& aOffer) {
+			if (options.maxWindowBits == 0) {
+				// Decline the offer, messages are sent uncompressed
+				return std::make_pair(websocketpp::extensions::error::make_error_code(websocketpp::extensions::error::disabled), std::string());
+			}
+
+			return base::negotiate(aOffer);
+		}
+	private:
+		const WebSocketDeflateOptions options;
+	};
+
+	struct asio_deflate : public websocketpp::config::asio {
+		typedef asio_deflate type;
+
+		struct permessage_deflate_config {};
+		typedef WebSocketDeflate<permessage_deflate_config> permessage_deflate_type;
+	};
+
+	// Connection data of the TLS endpoint
+	struct StreamConnectionBase {
+		// Returns the amount of data that has been passed to the write handler but hasn't been sent yet
+		std::function<size_t()> transportBufferedAmountF;
+	};
+
+	// TLS WebSockets are served by HttpConnection that handles the TLS stream
+	// and passes the decrypted data to websocketpp through the iostream transport
+	struct stream_tls_deflate : public websocketpp::config::core {
+		typedef stream_tls_deflate type;
+		typedef StreamConnectionBase connection_base;
+
+		struct permessage_deflate_config {};
+		typedef WebSocketDeflate<permessage_deflate_config> permessage_deflate_type;
+	};
+}
+
+#endif